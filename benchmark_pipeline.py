@@ -0,0 +1,166 @@
+"""
+End-to-end cost of solving swing equation with cpp solver from python
+
+Each stage of swing_solver.solve for cpp solver is timed separately
+- edge_list: edge list extraction from networkx graph
+- arg_file: formatting and writing argument file
+- spawn: process creation and teardown, i.e., subprocess time not spent in main
+- read: read_arg_file
+- parameters: Parameters construction from arguments
+- solve: solving swing equation
+- output: formatting trajectories to stdout, including transfer through pipe
+- numpy: parsing stdout to numpy array
+
+Usage: python benchmark_pipeline.py --nodes 100 1000 10000 --csv pipeline.csv
+"""
+
+import argparse
+import csv
+import string
+import subprocess
+import time
+from pathlib import Path
+
+import numpy as np
+
+from graph import get_er
+from graph.utils import get_edge_list
+from swing_solver import (
+    CPP_EXECUTABLE,
+    SOLVER_DIR,
+    compile_cpp,
+    get_cpp_command,
+    parse_cpp_output,
+    write_cpp_arg_file,
+)
+
+STAGES = [
+    "edge_list",
+    "arg_file",
+    "spawn",
+    "read",
+    "parameters",
+    "solve",
+    "output",
+    "numpy",
+]
+
+
+def run_pipeline(
+    solver_name: str,
+    graph,
+    weights: np.ndarray,
+    phase: np.ndarray,
+    dphase: np.ndarray,
+    params: np.ndarray,
+    dts: np.ndarray,
+) -> dict[str, float]:
+    """Time each stage of a single solve, in seconds"""
+    times: dict[str, float] = {}
+    suffix = "".join(np.random.choice(list(string.ascii_letters), 10))
+    arg_file = SOLVER_DIR / f"tmp_{suffix}.txt"
+    precision = 32 if dts.dtype == np.float32 else 64
+
+    start = time.perf_counter()
+    edge_list = get_edge_list(graph)
+    times["edge_list"] = time.perf_counter() - start
+
+    start = time.perf_counter()
+    write_cpp_arg_file(arg_file, edge_list, weights, phase, dphase, params, dts)
+    times["arg_file"] = time.perf_counter() - start
+
+    # Stages inside executable are reported to stderr by "timing" at solver name
+    start = time.perf_counter()
+    process = subprocess.run(
+        get_cpp_command(
+            f"{solver_name}_timing",
+            len(phase),
+            len(edge_list),
+            len(dts),
+            precision,
+            arg_file,
+        ),
+        capture_output=True,
+        text=True,
+        check=True,
+    )
+    wall = time.perf_counter() - start
+    arg_file.unlink()
+
+    for line in process.stderr.splitlines():
+        if line.startswith("Timing: "):
+            stage, seconds = line.removeprefix("Timing: ").split()
+            times[stage] = float(seconds)
+    if "total" not in times:
+        raise RuntimeError(f"{CPP_EXECUTABLE} does not report timing")
+    times["spawn"] = wall - times.pop("total")
+
+    start = time.perf_counter()
+    parse_cpp_output(process.stdout, dts.dtype, len(phase))
+    times["numpy"] = time.perf_counter() - start
+    return times
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--solver", default="rk4_cpp", help="solver name")
+    parser.add_argument("--nodes", type=int, nargs="+", default=[100, 1000, 10000])
+    parser.add_argument("--degree", type=float, default=4.0, help="mean degree")
+    parser.add_argument("--steps", type=int, default=100)
+    parser.add_argument("--precision", type=int, choices=[32, 64], default=64)
+    parser.add_argument("--repeats", type=int, default=5)
+    parser.add_argument(
+        "--seed", type=int, default=0, help="random seed of graph and state"
+    )
+    parser.add_argument("--csv", type=Path, help="path of csv report")
+    args = parser.parse_args()
+
+    compile_cpp()
+    dtype = np.float32 if args.precision == 32 else np.float64
+    random_engine = np.random.default_rng(args.seed)
+
+    rows = []
+    print(
+        f"{'N':>8} {'E':>9}"
+        + "".join(f"{stage:>12}" for stage in STAGES)
+        + f"{'total':>12} {'solve %':>8}"
+    )
+    for num_nodes in args.nodes:
+        graph = get_er(num_nodes, args.degree, seed=args.seed)
+        num_nodes, num_edges = graph.number_of_nodes(), graph.number_of_edges()
+        weights = np.ones(num_edges, dtype=dtype)
+        phase = random_engine.uniform(0.0, 2.0 * np.pi, num_nodes).astype(dtype)
+        dphase = random_engine.uniform(-1.0, 1.0, num_nodes).astype(dtype)
+        params = np.ones((3, num_nodes), dtype=dtype)
+        dts = np.full(args.steps, 0.01, dtype=dtype)
+
+        # Median over repeats, after a warmup run
+        run_pipeline(args.solver, graph, weights, phase, dphase, params, dts)
+        samples = [
+            run_pipeline(args.solver, graph, weights, phase, dphase, params, dts)
+            for _ in range(args.repeats)
+        ]
+        medians = {
+            stage: float(np.median([sample[stage] for sample in samples]))
+            for stage in STAGES
+        }
+        total = sum(medians.values())
+
+        print(
+            f"{num_nodes:>8} {num_edges:>9}"
+            + "".join(f"{medians[stage]:>12.3e}" for stage in STAGES)
+            + f"{total:>12.3e} {100.0 * medians['solve'] / total:>8.1f}"
+        )
+        rows.append(
+            {"num_nodes": num_nodes, "num_edges": num_edges, **medians, "total": total}
+        )
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=list(rows[0]))
+            writer.writeheader()
+            writer.writerows(rows)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,209 @@
+"""
+Performance regression gate of cpp solver
+
+Run solver/cpp/main_benchmark.cpp, store its samples at a history file keyed by git
+commit and machine fingerprint, and compare with the latest stored run of another
+commit on the same machine. A benchmark regresses when its median time grows more
+than the threshold and one-sided Mann-Whitney U test rejects "not slower" at alpha.
+
+Exit status: 0 if no regression, 1 if any benchmark regressed
+
+Usage: python benchmark_regression.py [--threshold 0.1] [--alpha 0.01]
+           [--baseline COMMIT] [--args "--nodes 1000,10000 --backends csr"]
+"""
+
+import argparse
+import hashlib
+import json
+import math
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+ROOT_DIR = Path(__file__).resolve().parent
+SOURCE = ROOT_DIR / "solver" / "cpp" / "main_benchmark.cpp"
+EXECUTABLE = ROOT_DIR / "solver" / "benchmark.out"
+
+# Fields identifying a benchmark across runs
+KEY_FIELDS = [
+    "benchmark",
+    "family",
+    "num_nodes",
+    "mean_degree",
+    "precision",
+    "solver",
+    "backend",
+    "threads",
+]
+
+
+def get_commit() -> str:
+    """Current commit, with "+dirty" when the tree has local changes"""
+    commit = subprocess.check_output(
+        ["git", "rev-parse", "HEAD"], cwd=ROOT_DIR, text=True
+    ).strip()
+    status = subprocess.check_output(
+        ["git", "status", "--porcelain", "--untracked-files=no"],
+        cwd=ROOT_DIR,
+        text=True,
+    )
+    return commit + ("+dirty" if status.strip() else "")
+
+
+def get_fingerprint(machine: dict) -> str:
+    """Hash of CPU model, number of threads and compiler"""
+    keys = ["cpu", "max_threads", "compiler"]
+    text = "|".join(str(machine.get(key)) for key in keys)
+    return hashlib.sha1(text.encode()).hexdigest()[:12]
+
+
+def get_key(result: dict) -> str:
+    return " ".join(str(result.get(field, "-")) for field in KEY_FIELDS)
+
+
+def mann_whitney_greater(new: list[float], old: list[float]) -> float:
+    """
+    p-value of one-sided Mann-Whitney U test, alternative: new is larger than old
+    Normal approximation with tie correction and continuity correction
+    """
+    n1, n2 = len(new), len(old)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    values = sorted(
+        (value, group) for group, sample in enumerate([new, old]) for value in sample
+    )
+
+    # Average rank of ties
+    ranks = [0.0] * len(values)
+    tie_sum = 0.0
+    i = 0
+    while i < len(values):
+        j = i
+        while j + 1 < len(values) and values[j + 1][0] == values[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2.0 + 1.0
+        tie_sum += (j - i + 1) ** 3 - (j - i + 1)
+        i = j + 1
+
+    rank_sum = sum(rank for rank, (_, group) in zip(ranks, values) if group == 0)
+    u = rank_sum - n1 * (n1 + 1) / 2.0
+    mean = n1 * n2 / 2.0
+    n = n1 + n2
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_sum / (n * (n - 1)))
+    if variance <= 0.0:
+        return 1.0
+    z = (u - mean - 0.5) / math.sqrt(variance)
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+def median(samples: list[float]) -> float:
+    ordered = sorted(samples)
+    n = len(ordered)
+    return ordered[n // 2] if n % 2 else 0.5 * (ordered[n // 2 - 1] + ordered[n // 2])
+
+
+def run_benchmark(benchmark_args: str) -> dict:
+    """Compile and run benchmark, return its JSON report"""
+    subprocess.run(
+        shlex.split(f"g++ -O2 -fopenmp -std=c++17 -o {EXECUTABLE} {SOURCE}"),
+        check=True,
+    )
+    with tempfile.TemporaryDirectory() as directory:
+        json_file = Path(directory) / "benchmark.json"
+        subprocess.run(
+            [str(EXECUTABLE), *shlex.split(benchmark_args), "--json", str(json_file)],
+            check=True,
+            cwd=directory,
+        )
+        return json.loads(json_file.read_text())
+
+
+def read_history(history_file: Path) -> list[dict]:
+    if not history_file.exists():
+        return []
+    with open(history_file) as f:
+        return [json.loads(line) for line in f if line.strip()]
+
+
+def find_baseline(
+    history: list[dict], fingerprint: str, commit: str, baseline: str | None
+) -> dict | None:
+    """Latest run on the same machine, of the baseline commit or any other commit"""
+    for entry in reversed(history):
+        if entry["fingerprint"] != fingerprint:
+            continue
+        if baseline is not None and entry["commit"].startswith(baseline):
+            return entry
+        if baseline is None and entry["commit"] != commit:
+            return entry
+    return None
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument(
+        "--args",
+        default="--benchmarks kernel,step,solve --precisions 64",
+        help="arguments of benchmark executable",
+    )
+    parser.add_argument(
+        "--history", type=Path, default=ROOT_DIR / "benchmark_history.jsonl"
+    )
+    parser.add_argument(
+        "--threshold", type=float, default=0.1, help="relative slowdown"
+    )
+    parser.add_argument("--alpha", type=float, default=0.01, help="significance level")
+    parser.add_argument("--baseline", help="commit to compare with")
+    parser.add_argument("--no-store", action="store_true", help="do not store this run")
+    args = parser.parse_args()
+
+    report = run_benchmark(args.args)
+    commit = get_commit()
+    fingerprint = get_fingerprint(report["machine"])
+    entry = {
+        "commit": commit,
+        "fingerprint": fingerprint,
+        "time": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        "machine": report["machine"],
+        "args": args.args,
+        "samples": {
+            get_key(result): result["time_samples"] for result in report["results"]
+        },
+    }
+
+    history = read_history(args.history)
+    baseline = find_baseline(history, fingerprint, commit, args.baseline)
+    if not args.no_store:
+        with open(args.history, "a") as f:
+            f.write(json.dumps(entry) + "\n")
+
+    if baseline is None:
+        print(f"No baseline of machine {fingerprint}. Stored {commit} as baseline")
+        return
+
+    print(f"Baseline {baseline['commit']} at {baseline['time']}, machine {fingerprint}")
+    regressions = 0
+    for key, samples in entry["samples"].items():
+        if key not in baseline["samples"]:
+            continue
+        old = baseline["samples"][key]
+        ratio = median(samples) / median(old)
+        p_value = mann_whitney_greater(samples, old)
+        regressed = ratio > 1.0 + args.threshold and p_value < args.alpha
+        regressions += regressed
+        print(
+            f"{'REGRESSION' if regressed else 'ok':<10} {key:<60} "
+            f"{ratio:>7.3f}x  p={p_value:.2e}"
+        )
+
+    if regressions:
+        print(f"{regressions} benchmarks regressed beyond {args.threshold:.0%}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,168 @@
+/*
+Monotonic arena of scratch memory, usable as std::pmr::memory_resource
+
+Allocation bumps an offset inside 64-byte aligned chunks, deallocation does
+nothing. Memory is given back all at once by rewinding to a marker, so that
+scratch buffers of every get_acceleration reuse the same chunks instead of going
+through the global allocator.
+
+Arena::Scope rewinds to the position at its construction when it goes out of
+scope: every allocation inside the scope must be dead by then, i.e., containers
+using the arena are declared after the scope and do not escape it.
+
+Each thread has its own arena (get_thread_arena), so parallel solves never share
+or lock an allocator. Allocation is meant for the serial part of the code, not
+inside OpenMP parallel regions.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+using Count = uint64_t;
+
+namespace Swing {
+
+class Arena : public std::pmr::memory_resource {
+   public:
+    static constexpr size_t alignment = 64;  // Cache line, widest SIMD register
+    static constexpr size_t min_chunk_size = 1 << 16;
+
+    /* Position of the arena: chunk and offset inside it */
+    struct Marker {
+        size_t chunk = 0;
+        size_t offset = 0;
+    };
+
+    /* Rewind to the position at construction when going out of scope */
+    class Scope {
+       public:
+        Scope(Arena& t_arena) : m_arena(t_arena), m_marker(t_arena.get_marker()) {}
+        ~Scope() { m_arena.rewind(m_marker); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        Arena& m_arena;
+        const Marker m_marker;
+    };
+
+    Arena() {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() { release(); }
+
+    const Marker get_marker() const { return m_marker; }
+    void rewind(const Marker& t_marker) { m_marker = t_marker; }
+    void reset();
+    void release();
+
+    //* Statistics in bytes, including alignment padding
+    const Count get_used() const;
+    const Count get_peak() const { return m_peak; }
+    const Count get_capacity() const;
+    const Count get_num_chunks() const { return m_chunks.size(); }
+    const Count get_num_allocations() const { return m_num_allocations; }
+
+   private:
+    struct Chunk {
+        std::byte* data;
+        size_t size;
+    };
+
+    std::vector<Chunk> m_chunks;
+    Marker m_marker;
+    Count m_peak = 0;
+    Count m_num_allocations = 0;
+
+    void* do_allocate(size_t t_bytes, size_t t_alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& t_other) const noexcept override {
+        return this == &t_other;
+    }
+};
+
+void* Arena::do_allocate(size_t t_bytes, size_t t_alignment) {
+    const size_t align = std::max(t_alignment, alignment);
+    ++m_num_allocations;
+
+    // First chunk from the marker with enough space
+    for (; m_marker.chunk < m_chunks.size(); ++m_marker.chunk) {
+        const Chunk& chunk = m_chunks[m_marker.chunk];
+        const size_t offset = (m_marker.offset + align - 1) / align * align;
+        if (offset + t_bytes <= chunk.size) {
+            m_marker.offset = offset + t_bytes;
+            m_peak = std::max(m_peak, get_used());
+            return chunk.data + offset;
+        }
+        m_marker.offset = 0;
+    }
+
+    // New chunk, at least twice the previous one
+    const size_t size = std::max(
+        {min_chunk_size,
+         (t_bytes + alignment - 1) / alignment * alignment,
+         m_chunks.empty() ? 0 : 2 * m_chunks.back().size}
+    );
+    m_chunks.push_back(
+        {static_cast<std::byte*>(::operator new(size, std::align_val_t(alignment))),
+         size}
+    );
+    m_marker = {m_chunks.size() - 1, t_bytes};
+    m_peak = std::max(m_peak, get_used());
+    return m_chunks.back().data;
+}
+
+/* Rewind to the beginning. Chunks are merged into one of the total capacity, so
+that the arena needs a single chunk from the next use on */
+void Arena::reset() {
+    if (m_chunks.size() > 1) {
+        const Count capacity = get_capacity();
+        release();
+        m_chunks.push_back(
+            {static_cast<std::byte*>(
+                 ::operator new(capacity, std::align_val_t(alignment))
+             ),
+             capacity}
+        );
+    }
+    m_marker = Marker();
+}
+
+/* Give every chunk back to the global allocator */
+void Arena::release() {
+    for (const Chunk& chunk : m_chunks) {
+        ::operator delete(chunk.data, std::align_val_t(alignment));
+    }
+    m_chunks.clear();
+    m_marker = Marker();
+}
+
+const Count Arena::get_used() const {
+    Count used = m_marker.offset;
+    for (size_t chunk = 0; chunk < m_marker.chunk && chunk < m_chunks.size(); ++chunk) {
+        used += m_chunks[chunk].size;
+    }
+    return used;
+}
+
+const Count Arena::get_capacity() const {
+    Count capacity = 0;
+    for (const Chunk& chunk : m_chunks) {
+        capacity += chunk.size;
+    }
+    return capacity;
+}
+
+/* Arena of the calling thread */
+Arena& get_thread_arena() {
+    thread_local Arena arena;
+    return arena;
+}
+
+}  // namespace Swing
@@ -1,9 +1,15 @@
 #pragma once
 
 #include <fstream>
+#include <iomanip>
+#include <limits>
+#include <ostream>
 #include <string>
 #include <vector>
 
+#include "parameters.hpp"
+#include "profiler.hpp"
+
 namespace Swing {
 
 /* Read argument file and store to single vector */
@@ -11,6 +17,7 @@ template <typename T>
 const std::vector<T> read_arg_file(
     const std::string& t_arg_file_name, const uint64_t& t_num_args, const T t_dummy
 ) {
+    SWING_PROFILE_SCOPE("read");
     std::ifstream arg_file(t_arg_file_name);
     std::vector<T> args;
     args.reserve(t_num_args);
@@ -31,4 +38,41 @@ const std::vector<T> read_arg_file(
     return args;
 }
 
+/* Write argument file in the format of swing_solver.step_solve_cpp */
+template <typename T>
+void write_arg_file(const std::string& t_arg_file_name, const Parameters<T>& t_params) {
+    std::ofstream arg_file(t_arg_file_name);
+    arg_file << std::fixed << std::setprecision(std::is_same<T, float>::value ? 6 : 16);
+    for (const std::vector<T>* property :
+         {&t_params.phase, &t_params.dphase, &t_params.power, &t_params.gamma,
+          &t_params.mass}) {
+        for (const T& value : *property) {
+            arg_file << value << "\n";
+        }
+    }
+    for (const auto& weighted_edge : t_params.weighted_edge_list) {
+        arg_file << weighted_edge.node1 << "\n"
+                 << weighted_edge.node2 << "\n"
+                 << weighted_edge.weight << "\n";
+    }
+    for (const T& dt : t_params.dts) {
+        arg_file << dt << "\n";
+    }
+    arg_file.close();
+}
+
+/* Write trajectories separated by space with maximum precision */
+template <typename T>
+void write_trajectories(
+    std::ostream& t_stream, const std::vector<std::vector<T>>& t_trajectories
+) {
+    SWING_PROFILE_SCOPE("output");
+    t_stream << std::setprecision(std::numeric_limits<T>::digits10 + 1);
+    for (const auto& trajectory : t_trajectories) {
+        for (const auto& traj : trajectory) {
+            t_stream << traj << " ";
+        }
+    }
+}
+
 }  // namespace Swing
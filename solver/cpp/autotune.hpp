@@ -0,0 +1,222 @@
+/*
+Autotune backend of cpp solver
+
+Candidate backends (network representation, node order, number of threads) are
+microbenchmarked with get_acceleration on the actual network. The winner is stored
+at a cache file keyed by (N, E, degree statistics, CPU model, precision), so that
+later runs on same kind of network start with the best backend without exploration.
+
+Cache file: $SWING_AUTOTUNE_CACHE, or autotune_cache.txt next to the executable
+Each line: key<TAB>backend
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "backend.hpp"
+#include "parameters.hpp"
+#include "reorder.hpp"
+#include "solver.hpp"
+
+namespace Swing {
+
+/* Model name of CPU. "unknown" if not found */
+const std::string get_cpu_model() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            const auto colon = line.find(':');
+            return line.substr(line.find_first_not_of(' ', colon + 1));
+        }
+    }
+    return "unknown";
+}
+
+/* Key of autotune cache: N|E|mean degree|max degree|CPU model|precision */
+template <typename T>
+const std::string get_autotune_key(const Parameters<T>& t_params) {
+    const Count num_nodes = t_params.phase.size();
+    const Count num_edges = t_params.weighted_edge_list.size();
+    std::vector<Count> degrees(num_nodes, 0);
+    for (const WeightedEdge<T>& weighted_edge : t_params.weighted_edge_list) {
+        ++degrees[weighted_edge.node1];
+        ++degrees[weighted_edge.node2];
+    }
+    const Count max_degree =
+        degrees.empty() ? 0 : *std::max_element(degrees.begin(), degrees.end());
+
+    std::ostringstream key;
+    key << num_nodes << "|" << num_edges << "|" << std::fixed << std::setprecision(2)
+        << (num_nodes ? 2.0 * num_edges / num_nodes : 0.0) << "|" << max_degree << "|"
+        << get_cpu_model() << "|" << 8 * sizeof(T);
+    return key.str();
+}
+
+const std::string get_autotune_cache_file() {
+    if (const char* cache_file = std::getenv("SWING_AUTOTUNE_CACHE")) {
+        return cache_file;
+    }
+    std::error_code error;
+    const auto executable = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (error) {
+        return "autotune_cache.txt";
+    }
+    return (executable.parent_path() / "autotune_cache.txt").string();
+}
+
+/* Find backend of the key at cache file. Empty network if not found */
+const Backend read_autotune_cache(
+    const std::string& t_cache_file,
+    const std::string& t_key
+) {
+    std::ifstream cache(t_cache_file);
+    std::string line;
+    Backend backend("", "", 0);
+    while (getline(cache, line)) {
+        const auto tab = line.find('\t');
+        if (tab != std::string::npos && line.substr(0, tab) == t_key) {
+            backend = Backend::from_string(line.substr(tab + 1));
+        }
+    }
+    return backend;
+}
+
+void write_autotune_cache(
+    const std::string& t_cache_file,
+    const std::string& t_key,
+    const Backend& t_backend
+) {
+    std::ofstream cache(t_cache_file, std::ios::app);
+    cache << t_key << "\t" << t_backend.to_string() << "\n";
+}
+
+/* Candidate backends worth trying on the network */
+template <typename T>
+const std::vector<Backend> get_autotune_candidates(const Parameters<T>& t_params) {
+    const Count num_nodes = t_params.phase.size();
+    const Count num_edges = t_params.weighted_edge_list.size();
+
+    const std::vector<int> thread_counts = get_thread_counts();
+    std::vector<Backend> candidates;
+    for (const std::string reorder : {"", "rcm", "degree", "gorder"}) {
+        candidates.emplace_back("scatter", reorder, 1);
+        for (const int& num_threads : thread_counts) {
+            candidates.emplace_back("csr", reorder, num_threads);
+        }
+    }
+
+    // Dense: density above 1/16 and matrix under 1GB
+    if (16 * 2 * num_edges >= num_nodes * num_nodes &&
+        num_nodes * num_nodes * sizeof(T) <= (1ULL << 30)) {
+        for (const int& num_threads : thread_counts) {
+            candidates.emplace_back("dense", "", num_threads);
+        }
+    }
+
+    // Mean-field: correction up to twice of edges
+    const T coupling = MeanField<T>::get_coupling(t_params.weighted_edge_list);
+    if (num_nodes >= 2 && MeanField<T>::get_num_corrections(
+                              num_nodes, t_params.weighted_edge_list, coupling
+                          ) <= 2 * num_edges) {
+        candidates.emplace_back("meanfield", "", 1);
+    }
+    return candidates;
+}
+
+/* Seconds per call of get_acceleration: minimum over 3 rounds of at least 5ms */
+template <typename T, typename Network>
+const double time_acceleration(
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params
+) {
+    using clock = std::chrono::steady_clock;
+    get_acceleration(t_network, t_state, t_params);  // warmup
+
+    double best = std::numeric_limits<double>::infinity();
+    for (int round = 0; round < 3; ++round) {
+        Count count = 0;
+        const auto start = clock::now();
+        std::chrono::duration<double> elapsed;
+        do {
+            get_acceleration(t_network, t_state, t_params);
+            ++count;
+            elapsed = clock::now() - start;
+        } while (elapsed.count() < 5e-3);
+        best = std::min(best, elapsed.count() / count);
+    }
+    return best;
+}
+
+/* Return the best backend of the network, from cache file or by microbenchmark */
+template <typename T>
+const Backend autotune(
+    const Parameters<T>& t_params,
+    const std::string& t_cache_file,
+    const bool& t_verbose = false
+) {
+    const std::string key = get_autotune_key(t_params);
+    const Backend cached = read_autotune_cache(t_cache_file, key);
+    if (not cached.network.empty()) {
+        if (t_verbose) {
+            std::cerr << "Autotune: cached " << cached.to_string() << "\n";
+        }
+        return cached;
+    }
+
+    Backend best;
+    double best_time = std::numeric_limits<double>::infinity();
+    std::string current_reorder = "none";
+    Parameters<T> params;
+    for (const Backend& candidate : get_autotune_candidates(t_params)) {
+        // Reorder once per method
+        if (candidate.reorder != current_reorder) {
+            params = t_params;
+            const std::vector<Node> order = get_node_order(
+                candidate.reorder, params.phase.size(), params.weighted_edge_list
+            );
+            if (not order.empty()) {
+                reorder(params, order);
+            }
+            current_reorder = candidate.reorder;
+        }
+
+        set_num_threads(candidate.num_threads);
+        const std::vector<std::vector<T>> state = {params.phase, params.dphase};
+        const std::vector<std::vector<T>> node_params = {
+            params.power, params.gamma, params.mass};
+        double time;
+        with_network(candidate.network, params, [&](const auto& t_network) {
+            time = time_acceleration(t_network, state, node_params);
+        });
+        if (t_verbose) {
+            std::cerr << "Autotune: " << candidate.to_string() << " " << time
+                      << " s\n";
+        }
+        if (time < best_time) {
+            best_time = time;
+            best = candidate;
+        }
+    }
+    set_num_threads(0);
+
+    write_autotune_cache(t_cache_file, key, best);
+    if (t_verbose) {
+        std::cerr << "Autotune: selected " << best.to_string() << "\n";
+    }
+    return best;
+}
+
+}  // namespace Swing
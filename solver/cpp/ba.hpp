@@ -0,0 +1,49 @@
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include "graph.hpp"
+#include "pcg_random.hpp"
+
+namespace BA {
+/* Generate Barabasi-Albert graph with given mean degree
+Start from complete graph of m+1 nodes, then each new node is attached to m distinct
+nodes with probability proportional to their degree, where m = mean degree / 2 */
+Graph generate_by_degree(
+    const Count& t_num_nodes, const double& t_mean_degree, pcg64& t_random_engine
+) {
+    const Count m = std::max((Count)1, (Count)(t_mean_degree / 2 + 0.5));
+    Graph graph(t_num_nodes);
+
+    // Each node appears as many times as its degree
+    std::vector<Node> attachments;
+    attachments.reserve(2 * m * t_num_nodes);
+    for (Node node1 = 0; node1 <= m && node1 < t_num_nodes; ++node1) {
+        for (Node node2 = 0; node2 < node1; ++node2) {
+            graph.add_edge(node1, node2);
+            attachments.emplace_back(node1);
+            attachments.emplace_back(node2);
+        }
+    }
+
+    std::vector<Node> targets;
+    for (Node node = m + 1; node < t_num_nodes; ++node) {
+        std::uniform_int_distribution<Count> distribution(0, attachments.size() - 1);
+        targets.clear();
+        while (targets.size() < m) {
+            const Node target = attachments[distribution(t_random_engine)];
+            if (not graph.has_edge(node, target)) {
+                graph.add_edge(node, target);
+                targets.emplace_back(target);
+            }
+        }
+        for (const Node& target : targets) {
+            attachments.emplace_back(node);
+            attachments.emplace_back(target);
+        }
+    }
+    return graph;
+}
+
+}  // namespace BA
@@ -0,0 +1,255 @@
+/*
+Backend of cpp solver: network representation, node order and number of threads
+
+network
+- scatter: weighted edge list, scatter interaction to both nodes of each edge
+- csr: compressed sparse row, gather interaction of each node
+- dense: dense weighted adjacency matrix
+- meanfield: complete graph with sparse correction
+reorder: "", rcm, degree, gorder
+num_threads: 0 for OpenMP default
+
+Precision mode is given by solver name, not by backend: with "mixed", csr sums
+neighbors at double precision and state update is compensated
+*/
+
+#pragma once
+
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "arena.hpp"
+#include "parameters.hpp"
+#include "reorder.hpp"
+#include "solver.hpp"
+#include "stability.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Swing {
+
+struct Backend {
+    std::string network = "scatter";
+    std::string reorder = "";
+    int num_threads = 0;
+
+    Backend() {}
+    Backend(
+        const std::string& t_network,
+        const std::string& t_reorder,
+        const int& t_num_threads
+    )
+        : network(t_network), reorder(t_reorder), num_threads(t_num_threads) {}
+
+    /* Written as "network reorder num_threads", "none" for no reorder */
+    const std::string to_string() const {
+        return network + " " + (reorder.empty() ? "none" : reorder) + " " +
+               std::to_string(num_threads);
+    }
+    static Backend from_string(const std::string& t_string) {
+        Backend backend;
+        std::istringstream stream(t_string);
+        stream >> backend.network >> backend.reorder >> backend.num_threads;
+        if (backend.reorder == "none") {
+            backend.reorder = "";
+        }
+        return backend;
+    }
+
+    template <typename T>
+    static Backend from_solver_name(const std::string&, const Parameters<T>&);
+};
+
+/* Backend specified by solver name, e.g., rk4_cpp_csr_rcm_threads4
+When network is not given, mean-field is selected for dense network */
+template <typename T>
+Backend Backend::from_solver_name(
+    const std::string& t_solver_name,
+    const Parameters<T>& t_params
+) {
+    Backend backend;
+    for (const std::string network : {"csr", "dense", "meanfield"}) {
+        if (t_solver_name.find(network) != std::string::npos) {
+            backend.network = network;
+        }
+    }
+    if (backend.network == "scatter" &&
+        MeanField<T>::is_efficient(t_params.phase.size(), t_params.weighted_edge_list)) {
+        backend.network = "meanfield";
+    }
+
+    backend.reorder = get_reorder_method(t_solver_name);
+
+    std::smatch match;
+    if (std::regex_search(t_solver_name, match, std::regex("threads([0-9]+)"))) {
+        backend.num_threads = std::stoi(match[1]);
+    }
+    return backend;
+}
+
+/* Jacobian of implicit and steady state solvers and node subsets of multirate
+solver need csr */
+const bool needs_csr(const std::string& t_solver_name) {
+    return t_solver_name.find("bdf2") != std::string::npos ||
+           t_solver_name.find("steady") != std::string::npos ||
+           t_solver_name.find("multirate") != std::string::npos;
+}
+
+/* Set number of OpenMP threads. 0: default */
+void set_num_threads(const int& t_num_threads) {
+#ifdef _OPENMP
+    static const int default_num_threads = omp_get_max_threads();
+    omp_set_num_threads(t_num_threads > 0 ? t_num_threads : default_num_threads);
+#endif
+}
+
+/* Maximum number of threads available */
+const int get_max_threads() {
+#ifdef _OPENMP
+    return omp_get_num_procs();
+#else
+    return 1;
+#endif
+}
+
+/* 1, 2, 4, ... up to maximum number of threads */
+const std::vector<int> get_thread_counts() {
+    std::vector<int> thread_counts;
+    for (int num_threads = 1; num_threads < get_max_threads(); num_threads *= 2) {
+        thread_counts.emplace_back(num_threads);
+    }
+    thread_counts.emplace_back(get_max_threads());
+    return thread_counts;
+}
+
+/* Build network of given representation and call t_function with it
+t_double_sums: per-node sums of csr at double precision, see csr.hpp */
+template <typename T, typename Function>
+void with_network(
+    const std::string& t_network,
+    const Parameters<T>& t_params,
+    Function&& t_function,
+    const bool& t_verbose = false,
+    const bool& t_double_sums = false
+) {
+    const Count num_nodes = t_params.phase.size();
+    if (t_network == "csr") {
+        CSR<T> csr(num_nodes, t_params.weighted_edge_list);
+        csr.uniform_node_params = t_params.is_uniform_node_params();
+        csr.double_sums = t_double_sums;
+        if (t_verbose) {
+            std::cerr << "Kernel: " << csr.get_kernel_name() << "\n";
+        }
+        t_function(csr);
+    } else if (t_network == "dense") {
+        if (t_verbose) {
+            std::cerr << "Kernel: dense\n";
+        }
+        t_function(DenseMatrix<T>(num_nodes, t_params.weighted_edge_list));
+    } else if (t_network == "meanfield") {
+        const MeanField<T> mean_field(num_nodes, t_params.weighted_edge_list);
+        if (t_verbose) {
+            std::cerr << "Kernel: mean field, " << mean_field.corrections.size()
+                      << " corrections\n";
+        }
+        t_function(mean_field);
+    } else {
+        if (t_verbose) {
+            std::cerr << "Kernel: scatter\n";
+        }
+        t_function(t_params.weighted_edge_list);
+    }
+}
+
+/* Solve swing equation with the backend, always csr for solvers of needs_csr
+Return (S+1, 2 * N) trajectories of the original node ids */
+template <typename T>
+std::vector<std::vector<T>> solve_backend(
+    const std::string& t_solver_name,
+    const Backend& t_backend,
+    Parameters<T> t_params,
+    const bool& t_verbose = false
+) {
+    set_num_threads(t_backend.num_threads);
+
+    //* Reorder nodes for cache locality
+    const std::vector<Node> order = get_node_order(
+        t_backend.reorder, t_params.phase.size(), t_params.weighted_edge_list
+    );
+    if (not order.empty()) {
+        reorder(t_params, order);
+    }
+
+    //* Run solver
+    std::vector<std::vector<T>> trajectories;
+    const std::vector<std::vector<T>> initial_state = {t_params.phase, t_params.dphase};
+    const std::vector<std::vector<T>> node_params = {
+        t_params.power, t_params.gamma, t_params.mass};
+    with_network(
+        needs_csr(t_solver_name) ? "csr" : t_backend.network,
+        t_params,
+        [&](const auto& t_network) {
+            trajectories = solve_network(
+                t_solver_name, t_network, initial_state, node_params, t_params.dts
+            );
+        },
+        t_verbose,
+        t_solver_name.find("mixed") != std::string::npos
+    );
+    if (t_verbose) {
+        const Arena& arena = get_thread_arena();
+        std::cerr << "Arena: peak " << arena.get_peak() << " bytes, "
+                  << arena.get_num_chunks() << " chunks\n";
+    }
+    // Merge chunks grown during this solve, so that the next solve needs a single one
+    get_thread_arena().reset();
+
+    //* Map back to original node ids
+    if (not order.empty()) {
+        restore_order(trajectories, order);
+    }
+    return trajectories;
+}
+
+/* Small-signal stability at the initial phases, or with "steady" at solver name at
+the phase-locked state of solve_steady. Always on csr */
+template <typename T>
+const StabilityReport analyze_backend(
+    const std::string& t_solver_name,
+    const Backend& t_backend,
+    Parameters<T> t_params,
+    const bool& t_verbose = false
+) {
+    set_num_threads(t_backend.num_threads);
+
+    //* Reorder nodes for cache locality: modes do not depend on node ids
+    const Count num_nodes = t_params.phase.size();
+    const std::vector<Node> order = get_node_order(
+        t_backend.reorder, num_nodes, t_params.weighted_edge_list
+    );
+    if (not order.empty()) {
+        reorder(t_params, order);
+    }
+
+    const CSR<T> csr(num_nodes, t_params.weighted_edge_list);
+    if (t_verbose) {
+        std::cerr << "Kernel: " << csr.get_kernel_name() << "\n";
+    }
+    const std::vector<std::vector<T>> node_params = {
+        t_params.power, t_params.gamma, t_params.mass};
+    std::vector<T> phase = t_params.phase;
+    if (t_solver_name.find("steady") != std::string::npos) {
+        const std::vector<T> steady =
+            solve_steady(csr, {t_params.phase, t_params.dphase}, node_params, {0.0})
+                .back();
+        phase.assign(steady.begin(), steady.begin() + num_nodes);
+    }
+    return analyze_stability(csr, phase, node_params);
+}
+
+}  // namespace Swing
@@ -0,0 +1,184 @@
+/*
+Utilities of benchmark: timing statistics and JSON report
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+
+/* Statistics of repeated timings in seconds */
+struct Stats {
+    int warmup = 0;
+    std::vector<double> samples;
+    double median = 0.0, p95 = 0.0, min = 0.0, mean = 0.0;
+
+    Stats() {}
+    Stats(const int& t_warmup, std::vector<double> t_samples)
+        : warmup(t_warmup), samples(t_samples) {
+        std::sort(t_samples.begin(), t_samples.end());
+        const size_t n = t_samples.size();
+        median = n % 2 ? t_samples[n / 2]
+                       : 0.5 * (t_samples[n / 2 - 1] + t_samples[n / 2]);
+        // Nearest rank
+        p95 = t_samples[std::max((size_t)1, (size_t)std::ceil(0.95 * n)) - 1];
+        min = t_samples.front();
+        mean = 0.0;
+        for (const double& sample : t_samples) {
+            mean += sample / n;
+        }
+    }
+};
+
+/* Run t_function t_warmup times, then time each of t_repeats runs */
+template <typename Function>
+Stats measure(Function&& t_function, const int& t_warmup, const int& t_repeats) {
+    using clock = std::chrono::steady_clock;
+    for (int i = 0; i < t_warmup; ++i) {
+        t_function();
+    }
+    std::vector<double> samples;
+    samples.reserve(t_repeats);
+    for (int i = 0; i < t_repeats; ++i) {
+        const auto start = clock::now();
+        t_function();
+        const std::chrono::duration<double> sec = clock::now() - start;
+        samples.emplace_back(sec.count());
+    }
+    return Stats(t_warmup, samples);
+}
+
+/* Keep result of benchmarked function from being optimized out */
+volatile double sink = 0.0;
+template <typename T>
+void keep(const std::vector<T>& t_result) {
+    sink = t_result.empty() ? 0.0 : (double)t_result[0];
+}
+
+/* Flat JSON object of string and number values, keeping insertion order
+Setting an existing key replaces its value */
+struct Record {
+    std::vector<std::pair<std::string, std::string>> fields;
+
+    Record& set(const std::string& t_key, const std::string& t_value) {
+        return put(t_key, "\"" + escape(t_value) + "\"");
+    }
+    Record& set(const std::string& t_key, const char* t_value) {
+        return set(t_key, std::string(t_value));
+    }
+    template <typename Number>
+    Record& set(const std::string& t_key, const Number& t_value) {
+        // NaN and infinity are not valid JSON
+        return put(t_key, std::isfinite((double)t_value) ? to_string(t_value) : "null");
+    }
+    Record& set(const std::string& t_key, const std::vector<double>& t_values) {
+        std::string array = "[";
+        for (size_t i = 0; i < t_values.size(); ++i) {
+            array += (i ? ", " : "") + to_string(t_values[i]);
+        }
+        return put(t_key, array + "]");
+    }
+    Record& set(const std::string& t_key, const Stats& t_stats) {
+        set(t_key + "_warmup", t_stats.warmup);
+        set(t_key + "_median", t_stats.median);
+        set(t_key + "_p95", t_stats.p95);
+        set(t_key + "_min", t_stats.min);
+        set(t_key + "_mean", t_stats.mean);
+        set(t_key + "_samples", t_stats.samples);
+        return *this;
+    }
+
+    /* Value of the key without quotes. Empty string if not found */
+    const std::string get(const std::string& t_key) const {
+        for (const auto& [key, value] : fields) {
+            if (key == t_key) {
+                return value.front() == '"' ? value.substr(1, value.size() - 2) : value;
+            }
+        }
+        return "";
+    }
+
+    /* Set JSON text of the value */
+    Record& put(const std::string& t_key, const std::string& t_json) {
+        for (auto& [key, value] : fields) {
+            if (key == t_key) {
+                value = t_json;
+                return *this;
+            }
+        }
+        fields.emplace_back(t_key, t_json);
+        return *this;
+    }
+
+    void write(std::ostream& t_stream) const {
+        t_stream << "{";
+        for (size_t i = 0; i < fields.size(); ++i) {
+            t_stream << (i ? ", " : "") << "\"" << fields[i].first
+                     << "\": " << fields[i].second;
+        }
+        t_stream << "}";
+    }
+
+    template <typename Number>
+    static std::string to_string(const Number& t_value) {
+        std::ostringstream stream;
+        stream << std::setprecision(std::numeric_limits<double>::digits10 + 1)
+               << t_value;
+        return stream.str();
+    }
+
+    static std::string escape(const std::string& t_string) {
+        std::string escaped;
+        for (const char& c : t_string) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+};
+
+/* Write {"machine": ..., "results": [...]} */
+void write_json(
+    std::ostream& t_stream,
+    const Record& t_machine,
+    const std::vector<Record>& t_results
+) {
+    t_stream << "{\n  \"machine\": ";
+    t_machine.write(t_stream);
+    t_stream << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < t_results.size(); ++i) {
+        t_stream << "    ";
+        t_results[i].write(t_stream);
+        t_stream << (i + 1 < t_results.size() ? ",\n" : "\n");
+    }
+    t_stream << "  ]\n}\n";
+}
+
+/* Split comma separated string */
+std::vector<std::string> split(
+    const std::string& t_string,
+    const char& t_delimiter = ','
+) {
+    std::vector<std::string> tokens;
+    std::string token;
+    std::istringstream stream(t_string);
+    while (getline(stream, token, t_delimiter)) {
+        if (not token.empty()) {
+            tokens.emplace_back(token);
+        }
+    }
+    return tokens;
+}
+
+}  // namespace Benchmark
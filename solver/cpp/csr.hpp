@@ -0,0 +1,117 @@
+/*
+Compressed sparse row (CSR) representation of weighted network
+
+Neighbors of node i are neighbors[offsets[i]:offsets[i+1]], with the weights at the
+same location. Each edge is stored in both directions, so the interaction of each
+node is gathered from its own row without scattering.
+Weights are kept separately from the indices and dropped entirely when every weight
+is 1 (unit-weight mode). Unit-weight and uniform node parameters are dispatched to
+template specialized kernels. At mixed precision mode, per-node sums are kept at
+double precision (see solver.hpp).
+*/
+
+#pragma once
+
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "profiler.hpp"
+#include "weighted_edge.hpp"
+
+using Count = uint64_t;
+
+namespace Swing {
+
+template <typename T, typename I = uint32_t>
+struct CSR {
+    Count num_nodes;
+    std::vector<I> offsets;    // (N+1, )
+    std::vector<I> neighbors;  // (2E, )
+    std::vector<T> weights;    // (2E, ), empty at unit-weight mode
+
+    // Set by the loader when power, gamma, mass are same for every node.
+    // Then the kernel reads them once from node 0 instead of streaming (3, N) values
+    bool uniform_node_params = false;
+
+    // Set by the loader at mixed precision mode: per-node sums of neighbors are
+    // accumulated at double precision while sin, cos and weights stay at T
+    bool double_sums = false;
+
+    CSR() {}
+    template <typename J>
+    CSR(const Count& t_num_nodes,
+        const std::vector<WeightedEdge<T, J>>& t_weighted_edge_list) {
+        SWING_PROFILE_SCOPE("network");
+        if (2 * t_weighted_edge_list.size() > std::numeric_limits<I>::max() ||
+            t_num_nodes > std::numeric_limits<I>::max()) {
+            std::cout << "Graph is too large for the index type of CSR\n";
+            exit(1);
+        }
+        num_nodes = t_num_nodes;
+
+        //* Unit-weight mode when every weight is 1
+        bool unit_weight = true;
+        for (const WeightedEdge<T, J>& weighted_edge : t_weighted_edge_list) {
+            if (weighted_edge.weight != (T)1.0) {
+                unit_weight = false;
+                break;
+            }
+        }
+
+        //* Offsets: cumulative sum of degrees
+        offsets.assign(num_nodes + 1, 0);
+        for (const WeightedEdge<T, J>& weighted_edge : t_weighted_edge_list) {
+            ++offsets[weighted_edge.node1 + 1];
+            ++offsets[weighted_edge.node2 + 1];
+        }
+        for (Count node = 0; node < num_nodes; ++node) {
+            offsets[node + 1] += offsets[node];
+        }
+
+        //* Neighbors and weights of each row
+        neighbors.assign(offsets.back(), 0);
+        if (not unit_weight) {
+            weights.assign(offsets.back(), 0.0);
+        }
+        std::vector<I> position(offsets.begin(), offsets.end() - 1);
+        for (const WeightedEdge<T, J>& weighted_edge : t_weighted_edge_list) {
+            const I idx1 = position[weighted_edge.node1]++;
+            const I idx2 = position[weighted_edge.node2]++;
+            neighbors[idx1] = weighted_edge.node2;
+            neighbors[idx2] = weighted_edge.node1;
+            if (not unit_weight) {
+                weights[idx1] = weighted_edge.weight;
+                weights[idx2] = weighted_edge.weight;
+            }
+        }
+    }
+
+    const bool is_unit_weight() const { return weights.empty(); }
+    const Count num_edges() const { return neighbors.size() / 2; }
+
+    /* Name of the specialized kernel, for logging */
+    const std::string get_kernel_name() const {
+        std::string name = "csr";
+        if (is_unit_weight()) {
+            name += ", unit weight";
+        }
+        if (uniform_node_params) {
+            name += ", uniform node parameters";
+        }
+        if (double_sums) {
+            name += ", double sums";
+        }
+        return name;
+    }
+};
+
+/* Whether the network type is CSR, for solvers needing its structure */
+template <typename Network>
+struct is_csr : std::false_type {};
+template <typename T, typename I>
+struct is_csr<CSR<T, I>> : std::true_type {};
+
+}  // namespace Swing
@@ -0,0 +1,50 @@
+/*
+Dense weighted adjacency matrix of network
+
+Rows are stored contiguously, each padded to a multiple of 16 values so that every
+row starts at the same alignment within cache line and SIMD loop has no remainder.
+Both triangles are stored: symmetric packed storage halves the memory, but a row
+parallel product then has to scatter to other rows.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "profiler.hpp"
+#include "weighted_edge.hpp"
+
+using Count = uint64_t;
+
+namespace Swing {
+
+template <typename T>
+struct DenseMatrix {
+    Count num_nodes;
+    Count stride;            // Padded length of each row
+    std::vector<T> weights;  // (N, stride), weights[i * stride + j] = K_ij
+
+    DenseMatrix() {}
+    template <typename I>
+    DenseMatrix(
+        const Count& t_num_nodes,
+        const std::vector<WeightedEdge<T, I>>& t_weighted_edge_list
+    )
+        : num_nodes(t_num_nodes) {
+        SWING_PROFILE_SCOPE("network");
+        stride = (num_nodes + 15) / 16 * 16;
+        weights.assign(num_nodes * stride, 0.0);
+        for (const WeightedEdge<T, I>& weighted_edge : t_weighted_edge_list) {
+            weights[weighted_edge.node1 * stride + weighted_edge.node2] =
+                weighted_edge.weight;
+            weights[weighted_edge.node2 * stride + weighted_edge.node1] =
+                weighted_edge.weight;
+        }
+    }
+
+    const T* get_row(const Count& t_row) const {
+        return weights.data() + t_row * stride;
+    }
+};
+
+}  // namespace Swing
@@ -19,7 +19,7 @@ struct Graph {
     std::vector<std::set<Node>> adjacency_list;  // set::find, set::erase is log(N)
 
     Graph() {}
-    Graph(const Count& t_num_nodes) : num_nodes(t_num_nodes) {
+    Graph(const Count& t_num_nodes) : num_nodes(t_num_nodes), num_edges(0) {
         adjacency_list.assign(num_nodes, std::set<Node>{});
     }
 
@@ -0,0 +1,200 @@
+/*
+Jacobian of the interaction on CSR network and Krylov solver of its linear systems
+
+Derivative of the interaction sum_j K_ij sin(theta_j - theta_i) by the phases is
+the negative of the Laplacian weighted by K_ij cos(theta_j - theta_i)
+    (L_cos v)_i = sum_j K_ij cos(theta_j - theta_i) (v_i - v_j)
+Since cos(theta_j - theta_i) = cos_i cos_j + sin_i sin_j, the product gathers
+K_ij cos_j v_j and K_ij sin_j v_j from each row of CSR: matrix-free, nothing of the
+size of the edges is stored. L_cos is symmetric, and positive semi-definite when
+every |theta_j - theta_i| < pi / 2. The same gathers give the interaction itself
+at construction.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "csr.hpp"
+#include "profiler.hpp"
+
+using Node = uint64_t;
+using Count = uint64_t;
+
+namespace Swing {
+
+template <typename T, typename I>
+class CosineLaplacian {
+   public:
+    CosineLaplacian(const CSR<T, I>& t_csr, const std::vector<T>& t_phase);
+
+    /* sum_j K_ij cos(theta_j - theta_i) of each node */
+    const std::vector<T>& get_diagonal() const { return m_diagonal; }
+
+    /* sum_j K_ij sin(theta_j - theta_i) of each node */
+    const std::vector<T>& get_interaction() const { return m_interaction; }
+
+    /* t_result = L_cos * t_vector */
+    void apply(const std::vector<T>& t_vector, std::vector<T>& t_result) const;
+
+   private:
+    const CSR<T, I>& m_csr;
+    std::vector<T> m_sin_phase;
+    std::vector<T> m_cos_phase;
+    std::vector<T> m_diagonal;
+    std::vector<T> m_interaction;
+
+    /* sum_j K_ij * t_values[j] of the node */
+    template <typename Function>
+    double gather(const Node& t_node, Function&& t_values) const {
+        const I* offsets = m_csr.offsets.data();
+        const I* neighbors = m_csr.neighbors.data();
+        double sum = 0.0;
+        if (m_csr.is_unit_weight()) {
+            for (I idx = offsets[t_node]; idx < offsets[t_node + 1]; ++idx) {
+                sum += t_values(neighbors[idx]);
+            }
+        } else {
+            const T* weights = m_csr.weights.data();
+            for (I idx = offsets[t_node]; idx < offsets[t_node + 1]; ++idx) {
+                sum += weights[idx] * t_values(neighbors[idx]);
+            }
+        }
+        return sum;
+    }
+};
+
+template <typename T, typename I>
+CosineLaplacian<T, I>::CosineLaplacian(
+    const CSR<T, I>& t_csr,
+    const std::vector<T>& t_phase
+)
+    : m_csr(t_csr) {
+    SWING_PROFILE_SCOPE("jacobian");
+    const Count num_nodes = t_phase.size();
+    m_sin_phase.resize(num_nodes);
+    m_cos_phase.resize(num_nodes);
+    m_diagonal.resize(num_nodes);
+    m_interaction.resize(num_nodes);
+#pragma omp parallel for schedule(static)
+    for (Node node = 0; node < num_nodes; ++node) {
+        m_sin_phase[node] = std::sin(t_phase[node]);
+        m_cos_phase[node] = std::cos(t_phase[node]);
+    }
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (Node node = 0; node < num_nodes; ++node) {
+        const double cos_sum = gather(node, [&](const I& j) { return m_cos_phase[j]; });
+        const double sin_sum = gather(node, [&](const I& j) { return m_sin_phase[j]; });
+        m_diagonal[node] = m_cos_phase[node] * cos_sum + m_sin_phase[node] * sin_sum;
+        m_interaction[node] = m_cos_phase[node] * sin_sum - m_sin_phase[node] * cos_sum;
+    }
+}
+
+template <typename T, typename I>
+void CosineLaplacian<T, I>::apply(
+    const std::vector<T>& t_vector,
+    std::vector<T>& t_result
+) const {
+    SWING_PROFILE_SCOPE("jacobian");
+    const Count num_nodes = t_vector.size();
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (Node node = 0; node < num_nodes; ++node) {
+        const double cos_sum =
+            gather(node, [&](const I& j) { return m_cos_phase[j] * t_vector[j]; });
+        const double sin_sum =
+            gather(node, [&](const I& j) { return m_sin_phase[j] * t_vector[j]; });
+        t_result[node] = m_diagonal[node] * t_vector[node] -
+                         (m_cos_phase[node] * cos_sum + m_sin_phase[node] * sin_sum);
+    }
+}
+
+/* Outcome of an iterative linear solver */
+struct KrylovResult {
+    int iterations = 0;
+    double relative_residual = 0.0;
+    bool converged = false;
+    bool indefinite = false;  // Non-positive curvature met: operator is not SPD
+};
+
+/* Dot product accumulated at double, in a fixed order for every thread count */
+template <typename T>
+const double dot(const std::vector<T>& t_vector1, const std::vector<T>& t_vector2) {
+    double sum = 0.0;
+    for (Count i = 0; i < t_vector1.size(); ++i) {
+        sum += (double)t_vector1[i] * t_vector2[i];
+    }
+    return sum;
+}
+
+/*
+Jacobi preconditioned conjugate gradient of symmetric positive definite operator
+
+t_apply(v, result): result = A * v
+t_inverse_diagonal: inverse of the diagonal of A, the preconditioner
+t_solution: initial guess, overwritten by the solution
+Stops when |r| <= t_tolerance * |b|, or at non-positive curvature
+*/
+template <typename T, typename Operator>
+KrylovResult solve_conjugate_gradient(
+    Operator&& t_apply,
+    const std::vector<T>& t_inverse_diagonal,
+    const std::vector<T>& t_rhs,
+    std::vector<T>& t_solution,
+    const double& t_tolerance,
+    const int& t_max_iterations
+) {
+    SWING_PROFILE_SCOPE("krylov");
+    const Count size = t_rhs.size();
+    KrylovResult result;
+
+    std::vector<T> residual(size), direction(size), preconditioned(size), product(size);
+    t_apply(t_solution, product);
+    for (Count i = 0; i < size; ++i) {
+        residual[i] = t_rhs[i] - product[i];
+        preconditioned[i] = t_inverse_diagonal[i] * residual[i];
+    }
+    direction = preconditioned;
+
+    const double rhs_norm = std::sqrt(dot(t_rhs, t_rhs));
+    if (rhs_norm == 0.0) {
+        std::fill(t_solution.begin(), t_solution.end(), 0.0);
+        result.converged = true;
+        return result;
+    }
+    double rho = dot(residual, preconditioned);
+    for (; result.iterations < t_max_iterations; ++result.iterations) {
+        result.relative_residual = std::sqrt(dot(residual, residual)) / rhs_norm;
+        if (result.relative_residual <= t_tolerance) {
+            result.converged = true;
+            break;
+        }
+
+        t_apply(direction, product);
+        const double curvature = dot(direction, product);
+        if (curvature <= 0.0) {
+            result.indefinite = true;
+            break;
+        }
+        const double alpha = rho / curvature;
+        for (Count i = 0; i < size; ++i) {
+            t_solution[i] += alpha * direction[i];
+            residual[i] -= alpha * product[i];
+            preconditioned[i] = t_inverse_diagonal[i] * residual[i];
+        }
+
+        const double next_rho = dot(residual, preconditioned);
+        const double beta = next_rho / rho;
+        rho = next_rho;
+        for (Count i = 0; i < size; ++i) {
+            direction[i] = preconditioned[i] + beta * direction[i];
+        }
+    }
+    if (not result.converged && not result.indefinite) {
+        result.relative_residual = std::sqrt(dot(residual, residual)) / rhs_norm;
+    }
+    return result;
+}
+
+}  // namespace Swing
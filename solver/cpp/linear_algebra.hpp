@@ -5,6 +5,7 @@
 #include <iostream>
 #include <map>
 #include <numeric>
+#include <type_traits>
 #include <vector>
 
 namespace LinearAlgebra {
@@ -30,20 +31,103 @@ std::vector<std::vector<T>> transpose(const std::vector<std::vector<T>>& t_mat)
     return result;
 }
 
-//* vector + vector -> vector
+//* Expression templates of vector arithmetic
+// Arithmetic of vectors and scalars builds a lazy expression whose element i is
+// evaluated on demand. Converting it to std::vector evaluates the whole expression
+// in a single loop, e.g., (v1 + 2.0 * v2) / 6.0 allocates only its result.
+// Each operation still rounds to T, so results are identical to eager evaluation.
+// Operand vectors are referenced, not copied: do not keep an expression with auto
+// beyond the statement that creates it.
+template <typename T, typename Function>
+struct VectorExpression {
+    using value_type = T;
+    size_t num_elements;
+    Function function;  // Element i
+
+    VectorExpression(const size_t& t_num_elements, const Function& t_function)
+        : num_elements(t_num_elements), function(t_function) {}
+
+    const size_t size() const { return num_elements; }
+    const T operator[](const size_t& t_idx) const { return function(t_idx); }
+
+    operator std::vector<T>() const {
+        std::vector<T> result(num_elements);
+        T* data = result.data();
+#pragma omp simd
+        for (size_t i = 0; i < num_elements; ++i) {
+            data[i] = function(i);
+        }
+        return result;
+    }
+};
+
+// Scalar operand of vector and matrix arithmetic
+template <typename TT>
+using enable_if_arithmetic = std::enable_if_t<std::is_arithmetic_v<TT>>;
+
+// Vector of arithmetic type or its expression
+template <typename V>
+struct VectorTraits {
+    static constexpr bool is_vector = false;
+};
 template <typename T>
-std::vector<T> operator+(const std::vector<T>& t_vec1, const std::vector<T>& t_vec2) {
+struct VectorTraits<std::vector<T>> {
+    static constexpr bool is_vector = std::is_arithmetic_v<T>;
+    using value_type = T;
+};
+template <typename T, typename Function>
+struct VectorTraits<VectorExpression<T, Function>> {
+    static constexpr bool is_vector = true;
+    using value_type = T;
+};
+template <typename V>
+constexpr bool is_vector_v = VectorTraits<V>::is_vector;
+template <typename V>
+using vector_value_t = typename VectorTraits<V>::value_type;
+
+// Element i of an operand
+template <typename T>
+auto get_element(const std::vector<T>& t_vec) {
+    const T* data = t_vec.data();
+    return [data](const size_t& t_idx) { return data[t_idx]; };
+}
+template <typename T, typename Function>
+const Function& get_element(const VectorExpression<T, Function>& t_expression) {
+    return t_expression.function;
+}
+
+template <typename T, typename Function>
+VectorExpression<T, Function> make_expression(
+    const size_t& t_num_elements,
+    const Function& t_function
+) {
+    return VectorExpression<T, Function>(t_num_elements, t_function);
+}
+
+template <typename V1, typename V2>
+void check_same_size(const V1& t_vec1, const V2& t_vec2) {
     if (t_vec1.size() != t_vec2.size()) {
         std::cout << "In plus operation, two vectors have different length"
                   << std::endl;
         exit(1);
     }
+}
 
-    std::vector<T> result(t_vec1.size());
-    for (unsigned i = 0; i < t_vec1.size(); ++i) {
-        result[i] = t_vec1[i] + t_vec2[i];
-    }
-    return result;
+//* vector + vector -> vector
+template <
+    typename V1,
+    typename V2,
+    std::enable_if_t<is_vector_v<V1> && is_vector_v<V2>, int> = 0>
+auto operator+(const V1& t_vec1, const V2& t_vec2) {
+    using T = vector_value_t<V1>;
+    check_same_size(t_vec1, t_vec2);
+    return make_expression<T>(
+        t_vec1.size(),
+        [element1 = get_element(t_vec1),
+         element2 = get_element(t_vec2)](const size_t& t_idx) -> T {
+            return element1(t_idx) + element2(t_idx);
+        }
+    );
 }
 template <typename T>
 std::vector<T>& operator+=(std::vector<T>& t_vec1, const std::vector<T>& t_vec2) {
@@ -59,20 +143,34 @@ std::vector<T>& operator+=(std::vector<T>& t_vec1, const std::vector<T>& t_vec2)
     }
     return t_vec1;
 }
+template <typename T, typename Function>
+std::vector<T>& operator+=(
+    std::vector<T>& t_vec, const VectorExpression<T, Function>& t_expression
+) {
+    check_same_size(t_vec, t_expression);
+    T* data = t_vec.data();
+#pragma omp simd
+    for (size_t i = 0; i < t_vec.size(); ++i) {
+        data[i] += t_expression.function(i);
+    }
+    return t_vec;
+}
 
 //* vector - vector -> vector
-template <typename T>
-std::vector<T> operator-(const std::vector<T>& t_vec1, const std::vector<T>& t_vec2) {
-    if (t_vec1.size() != t_vec2.size()) {
-        std::cout << "In plus operation, two vectors have different length"
-                  << std::endl;
-        exit(1);
-    }
-    std::vector<T> result(t_vec1.size());
-    for (unsigned i = 0; i < t_vec1.size(); ++i) {
-        result[i] = t_vec1[i] - t_vec2[i];
-    }
-    return result;
+template <
+    typename V1,
+    typename V2,
+    std::enable_if_t<is_vector_v<V1> && is_vector_v<V2>, int> = 0>
+auto operator-(const V1& t_vec1, const V2& t_vec2) {
+    using T = vector_value_t<V1>;
+    check_same_size(t_vec1, t_vec2);
+    return make_expression<T>(
+        t_vec1.size(),
+        [element1 = get_element(t_vec1),
+         element2 = get_element(t_vec2)](const size_t& t_idx) -> T {
+            return element1(t_idx) - element2(t_idx);
+        }
+    );
 }
 template <typename T>
 std::vector<T>& operator-=(std::vector<T>& t_vec1, const std::vector<T>& t_vec2) {
@@ -86,6 +184,18 @@ std::vector<T>& operator-=(std::vector<T>& t_vec1, const std::vector<T>& t_vec2)
     }
     return t_vec1;
 }
+template <typename T, typename Function>
+std::vector<T>& operator-=(
+    std::vector<T>& t_vec, const VectorExpression<T, Function>& t_expression
+) {
+    check_same_size(t_vec, t_expression);
+    T* data = t_vec.data();
+#pragma omp simd
+    for (size_t i = 0; i < t_vec.size(); ++i) {
+        data[i] -= t_expression.function(i);
+    }
+    return t_vec;
+}
 
 //* matrix + matrix -> matrix
 template <typename T>
@@ -155,20 +265,27 @@ std::vector<std::vector<T>>& operator-=(
 }
 
 //* const * vector -> vector
-template <typename T, typename TT>
-std::vector<T> operator*(const TT& c, const std::vector<T>& t_vec) {
-    std::vector<T> result;
-    result.reserve(t_vec.size());
-    for (const T& e : t_vec) {
-        result.emplace_back(c * e);
-    }
-    return result;
+template <
+    typename TT,
+    typename V,
+    std::enable_if_t<std::is_arithmetic_v<TT> && is_vector_v<V>, int> = 0>
+auto operator*(const TT& c, const V& t_vec) {
+    using T = vector_value_t<V>;
+    return make_expression<T>(
+        t_vec.size(),
+        [c, element = get_element(t_vec)](const size_t& t_idx) -> T {
+            return c * element(t_idx);
+        }
+    );
 }
-template <typename T, typename TT>
-std::vector<T> operator*(const std::vector<T>& t_vec, const TT& c) {
+template <
+    typename V,
+    typename TT,
+    std::enable_if_t<std::is_arithmetic_v<TT> && is_vector_v<V>, int> = 0>
+auto operator*(const V& t_vec, const TT& c) {
     return c * t_vec;
 }
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<T>& operator*=(std::vector<T>& t_vec, const TT& c) {
     for (T& e : t_vec) {
         e *= c;
@@ -177,7 +294,7 @@ std::vector<T>& operator*=(std::vector<T>& t_vec, const TT& c) {
 }
 
 //* const * matrix -> matrix
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<std::vector<T>> operator*(
     const TT& c, const std::vector<std::vector<T>>& t_mat
 ) {
@@ -192,13 +309,13 @@ std::vector<std::vector<T>> operator*(
     }
     return result;
 }
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<std::vector<T>> operator*(
     const std::vector<std::vector<T>>& t_mat, const TT& c
 ) {
     return c * t_mat;
 }
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<std::vector<T>>& operator*=(
     std::vector<std::vector<T>>& t_mat, const TT& c
 ) {
@@ -209,15 +326,20 @@ std::vector<std::vector<T>>& operator*=(
 }
 
 //* vector / const -> vector
-template <typename T, typename TT>
-std::vector<T> operator/(const std::vector<T>& t_vec, const TT& c) {
-    std::vector<T> result(t_vec.size());
-    for (unsigned i = 0; i < t_vec.size(); ++i) {
-        result[i] = t_vec[i] / c;
-    }
-    return result;
+template <
+    typename V,
+    typename TT,
+    std::enable_if_t<std::is_arithmetic_v<TT> && is_vector_v<V>, int> = 0>
+auto operator/(const V& t_vec, const TT& c) {
+    using T = vector_value_t<V>;
+    return make_expression<T>(
+        t_vec.size(),
+        [c, element = get_element(t_vec)](const size_t& t_idx) -> T {
+            return element(t_idx) / c;
+        }
+    );
 }
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<T>& operator/=(std::vector<T>& t_vec, const TT& c) {
     for (T& e : t_vec) {
         e /= c;
@@ -226,7 +348,7 @@ std::vector<T>& operator/=(std::vector<T>& t_vec, const TT& c) {
 }
 
 //* matrix / c -> matrix
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<std::vector<T>> operator/(
     const std::vector<std::vector<T>>& t_mat, const TT& c
 ) {
@@ -241,7 +363,7 @@ std::vector<std::vector<T>> operator/(
     }
     return result;
 }
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<std::vector<T>>& operator/=(
     std::vector<std::vector<T>>& t_mat, const TT& c
 ) {
@@ -252,16 +374,20 @@ std::vector<std::vector<T>>& operator/=(
 }
 
 //* vector + c -> vector
-template <typename T, typename TT>
-std::vector<T> operator+(const std::vector<T>& t_vec, const TT& c) {
-    const unsigned n = t_vec.size();
-    std::vector<T> result(n);
-    for (unsigned i = 0; i < n; ++i) {
-        result[i] = t_vec[i] + c;
-    }
-    return result;
+template <
+    typename V,
+    typename TT,
+    std::enable_if_t<std::is_arithmetic_v<TT> && is_vector_v<V>, int> = 0>
+auto operator+(const V& t_vec, const TT& c) {
+    using T = vector_value_t<V>;
+    return make_expression<T>(
+        t_vec.size(),
+        [c, element = get_element(t_vec)](const size_t& t_idx) -> T {
+            return element(t_idx) + c;
+        }
+    );
 }
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<T>& operator+=(std::vector<T>& t_vec, const TT& c) {
     for (T& e : t_vec) {
         e += c;
@@ -270,23 +396,33 @@ std::vector<T>& operator+=(std::vector<T>& t_vec, const TT& c) {
 }
 
 //* vector - const -> vector
-template <typename T, typename TT>
-std::vector<T> operator-(const std::vector<T>& t_vec, const TT& c) {
-    std::vector<T> result(t_vec.size());
-    for (unsigned i = 0; i < t_vec.size(); ++i) {
-        result[i] = t_vec[i] - c;
-    }
-    return result;
-}
-template <typename T, typename TT>
-std::vector<T> operator-(const TT& c, const std::vector<T>& t_vec) {
-    std::vector<T> result(t_vec.size());
-    for (unsigned i = 0; i < t_vec.size(); ++i) {
-        result[i] = c - t_vec[i];
-    }
-    return result;
+template <
+    typename V,
+    typename TT,
+    std::enable_if_t<std::is_arithmetic_v<TT> && is_vector_v<V>, int> = 0>
+auto operator-(const V& t_vec, const TT& c) {
+    using T = vector_value_t<V>;
+    return make_expression<T>(
+        t_vec.size(),
+        [c, element = get_element(t_vec)](const size_t& t_idx) -> T {
+            return element(t_idx) - c;
+        }
+    );
+}
+template <
+    typename TT,
+    typename V,
+    std::enable_if_t<std::is_arithmetic_v<TT> && is_vector_v<V>, int> = 0>
+auto operator-(const TT& c, const V& t_vec) {
+    using T = vector_value_t<V>;
+    return make_expression<T>(
+        t_vec.size(),
+        [c, element = get_element(t_vec)](const size_t& t_idx) -> T {
+            return c - element(t_idx);
+        }
+    );
 }
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<T>& operator-=(std::vector<T>& t_vec, const TT& c) {
     for (T& e : t_vec) {
         e -= c;
@@ -295,7 +431,7 @@ std::vector<T>& operator-=(std::vector<T>& t_vec, const TT& c) {
 }
 
 //* const + matrix -> matrix
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<std::vector<T>> operator+(
     const std::vector<std::vector<T>>& t_mat, const TT& c
 ) {
@@ -310,7 +446,7 @@ std::vector<std::vector<T>> operator+(
     }
     return result;
 }
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<std::vector<T>>& operator+=(
     std::vector<std::vector<T>>& t_mat, const TT& c
 ) {
@@ -321,7 +457,7 @@ std::vector<std::vector<T>>& operator+=(
 }
 
 //* matrix - const -> matrix
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<std::vector<T>> operator-(
     const std::vector<std::vector<T>>& t_mat, const TT& c
 ) {
@@ -336,7 +472,7 @@ std::vector<std::vector<T>> operator-(
     }
     return result;
 }
-template <typename T, typename TT>
+template <typename T, typename TT, typename = enable_if_arithmetic<TT>>
 std::vector<std::vector<T>>& operator-=(
     std::vector<std::vector<T>>& t_mat, const TT& c
 ) {
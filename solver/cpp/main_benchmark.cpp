@@ -0,0 +1,950 @@
+/*
+Benchmark suite of cpp solver
+
+Compile: g++ -O2 -fopenmp -std=c++17 -o benchmark.out main_benchmark.cpp
+Usage: ./benchmark.out [--option value1,value2,...]
+    --benchmarks    kernel, step, solve, io, generate, roofline, strong, weak,
+                    accuracy (default: kernel,step,solve,io,generate)
+    --families      er, ba (default: er)
+    --nodes         number of nodes (default: 1000,10000)
+    --degrees       mean degree (default: 4,16)
+    --precisions    32, 64, mixed (default: 32,64). mixed: float with double
+                    per-node sums and compensated state update, accuracy of
+                    rk1, rk2, rk4 only
+    --solvers       rk1, rk2, rk4, lsrk3, lsrk4, verlet, leapfrog, strang, ab4,
+                    abm4, bdf2, multirate, steady (default: rk4). bdf2, multirate
+                    and steady run on csr alone. A step of steady is its whole
+                    Newton solve, which exits without a phase-locked state
+    --backends      solver name of backend, e.g., scatter, csr, csr_rcm, dense,
+                    meanfield, csr_threads4 (default: scatter,csr)
+    --threads       number of threads, 0 for OpenMP default (default: 0)
+    --steps         number of steps of full solve (default: 100)
+    --warmup        number of warmup runs (default: 2)
+    --repeats       number of timed runs (default: 10)
+    --stream        number of doubles of each STREAM array (default: 16777216)
+    --dts           dt of accuracy benchmark (default: 0.04,0.02,0.01,0.005)
+    --duration      simulated time of accuracy benchmark (default: 10)
+    --tolerances    errors to find the fastest solver (default: 1e-2,1e-4,1e-6,1e-8)
+    --budgets       seconds to find the most accurate solver (default: none)
+    --seed          random seed of graph and parameters (default: 0)
+    --json          path of JSON report
+
+- kernel: single get_acceleration
+- step: single Runge-Kutta step
+- solve: full solve including reorder and network construction
+- io: parse of argument file and output of trajectories
+- generate: generation of graph
+- roofline: bandwidth and flops of get_acceleration against measured STREAM
+  bandwidth and peak flops, see roofline.hpp
+- strong: get_acceleration of the graph at 1, 2, 4, ... threads
+- weak: get_acceleration at 1, 2, 4, ... threads, N growing with threads
+- accuracy: error of final state against double precision rk4 at 1/8 of the
+  smallest dt, and wall-clock time of each solver, precision, backend and dt.
+  Timed solves store the full trajectory like the python interface does, while
+  the reference keeps the final state alone. Pareto frontier, fastest solver at
+  each tolerance and most accurate solver at each budget are printed per graph
+
+Each result reports median, p95 over repeats and edges per second
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arguments.hpp"
+#include "autotune.hpp"
+#include "ba.hpp"
+#include "backend.hpp"
+#include "benchmark.hpp"
+#include "er.hpp"
+#include "parameters.hpp"
+#include "pcg_random.hpp"
+#include "perf_counter.hpp"
+#include "reorder.hpp"
+#include "roofline.hpp"
+#include "solver.hpp"
+
+namespace Swing {
+
+struct BenchmarkOptions {
+    std::map<std::string, std::string> values = {
+        {"benchmarks", "kernel,step,solve,io,generate"},
+        {"families", "er"},
+        {"nodes", "1000,10000"},
+        {"degrees", "4,16"},
+        {"precisions", "32,64"},
+        {"solvers", "rk4"},
+        {"backends", "scatter,csr"},
+        {"threads", "0"},
+        {"steps", "100"},
+        {"warmup", "2"},
+        {"repeats", "10"},
+        {"stream", "16777216"},
+        {"dts", "0.04,0.02,0.01,0.005"},
+        {"duration", "10"},
+        {"tolerances", "1e-2,1e-4,1e-6,1e-8"},
+        {"budgets", ""},
+        {"seed", "0"},
+        {"json", ""},
+    };
+
+    BenchmarkOptions(int argc, char* argv[]) {
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const std::string key = std::string(argv[i]).substr(2);
+            if (values.find(key) == values.end()) {
+                std::cout << "Unknown option " << argv[i] << "\n";
+                exit(1);
+            }
+            values[key] = argv[i + 1];
+        }
+    }
+
+    const std::vector<std::string> get_list(const std::string& t_key) const {
+        return Benchmark::split(values.at(t_key));
+    }
+    const bool has(const std::string& t_key, const std::string& t_value) const {
+        const auto list = get_list(t_key);
+        return std::find(list.begin(), list.end(), t_value) != list.end();
+    }
+    const int get_int(const std::string& t_key) const {
+        return std::stoi(values.at(t_key));
+    }
+};
+
+/* Graph of the family: er, ba */
+const Graph generate_graph(
+    const std::string& t_family,
+    const Count& t_num_nodes,
+    const double& t_mean_degree,
+    pcg64& t_random_engine
+) {
+    if (t_family == "ba") {
+        return BA::generate_by_degree(t_num_nodes, t_mean_degree, t_random_engine);
+    }
+    return ER::generate_by_degree(t_num_nodes, t_mean_degree, t_random_engine);
+}
+
+/* Number of get_acceleration calls per step */
+const int get_num_stages(const std::string& t_solver_name) {
+    if (t_solver_name.find("bdf2") != std::string::npos ||
+        t_solver_name.find("steady") != std::string::npos) {
+        return 1;  // Newton iterations vary: counted as a single edge visit per step
+    } else if (t_solver_name.find("abm4") != std::string::npos) {
+        return 2;
+    } else if (t_solver_name.find("ab4") != std::string::npos ||
+               t_solver_name.find("verlet") != std::string::npos ||
+               t_solver_name.find("leapfrog") != std::string::npos ||
+               t_solver_name.find("strang") != std::string::npos) {
+        return 1;
+    } else if (t_solver_name.find("lsrk") != std::string::npos) {
+        return get_low_storage_tableau(t_solver_name).get_num_stages();
+    } else if (t_solver_name.find("rk1") != std::string::npos) {
+        return 1;
+    } else if (t_solver_name.find("rk2") != std::string::npos) {
+        return 2;
+    }
+    return 4;
+}
+
+/* Single Runge-Kutta step of the order given in solver name
+Copies of state of low-storage step are part of the measured time, as rk1, rk2, rk4
+allocate their new state */
+template <typename T, typename Network>
+std::vector<std::vector<T>> step_network(
+    const std::string& t_solver_name,
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params,
+    const T& t_dt
+) {
+    if (needs_csr(t_solver_name)) {
+        // Single step solve. First step of bdf2 is backward Euler with the same
+        // Newton-Krylov solve, that of multirate has no jerk of slow nodes, and
+        // steady solves the phase-locked state whatever the step
+        if constexpr (is_csr<Network>::value) {
+            const std::vector<T> flat =
+                solve_network(t_solver_name, t_network, t_state, t_params, {t_dt})
+                    .back();
+            const Count num_nodes = t_state[0].size();
+            return {
+                std::vector<T>(flat.begin(), flat.begin() + num_nodes),
+                std::vector<T>(flat.begin() + num_nodes, flat.end())};
+        }
+        return t_state;
+    } else if (t_solver_name.find("ab4") != std::string::npos ||
+               t_solver_name.find("abm4") != std::string::npos) {
+        // History of a solve is not part of a step: zero derivatives are used at
+        // past times, only the time matters here
+        const Count num_nodes = t_state[0].size();
+        std::vector<std::vector<T>> state = t_state;
+        std::vector<std::vector<T>> next_state = t_state;
+        std::vector<std::vector<T>> predicted_derivative = t_state;
+        DerivativeHistory<T> history(num_nodes);
+        for (Count lag = adams_order; lag > 0; --lag) {
+            for (std::vector<T>& derivative : history.push((1.0 - lag) * t_dt)) {
+                std::fill(derivative.begin(), derivative.end(), 0.0);
+            }
+        }
+        step_adams(
+            t_network,
+            state,
+            next_state,
+            predicted_derivative,
+            history,
+            t_params,
+            0.0,
+            t_dt,
+            t_solver_name.find("abm4") != std::string::npos
+        );
+        return state;
+    } else if (t_solver_name.find("strang") != std::string::npos) {
+        // LocalFlow is built once per dt at a solve, but at every step here
+        std::vector<std::vector<T>> state = t_state;
+        const std::vector<std::vector<T>> coupling_params = {
+            std::vector<T>(t_params[2].size(), 0.0),
+            std::vector<T>(t_params[2].size(), 0.0),
+            t_params[2]};
+        const LocalFlow<T> half_flow(t_params, 0.5 * t_dt);
+        step_strang(t_network, state, coupling_params, half_flow, t_dt);
+        return state;
+    } else if (t_solver_name.find("verlet") != std::string::npos ||
+               t_solver_name.find("leapfrog") != std::string::npos) {
+        // Cached acceleration of verlet is carried over between steps of a solve,
+        // so it is not part of a step: zero is used, only the time matters here.
+        // DampedKick is built once per dt at a solve, but at every step here
+        std::vector<std::vector<T>> state = t_state;
+        const std::vector<std::vector<T>> conservative_params =
+            get_conservative_params(t_params);
+        if (t_solver_name.find("leapfrog") != std::string::npos) {
+            const DampedKick<T> kick(t_params, t_dt);
+            step_leapfrog(t_network, state, conservative_params, kick, t_dt);
+        } else {
+            const DampedKick<T> half_kick(t_params, 0.5 * t_dt);
+            std::vector<T> acceleration(t_state[0].size(), 0.0);
+            step_verlet(
+                t_network, state, acceleration, conservative_params, half_kick, t_dt
+            );
+        }
+        return state;
+    } else if (t_solver_name.find("lsrk") != std::string::npos) {
+        std::vector<std::vector<T>> state = t_state;
+        std::vector<std::vector<T>> register_state = t_state;
+        step_low_storage(
+            t_network,
+            state,
+            register_state,
+            t_params,
+            get_low_storage_tableau(t_solver_name),
+            t_dt
+        );
+        return state;
+    } else if (t_solver_name.find("rk1") != std::string::npos) {
+        return step_rk1(t_network, t_state, t_params, t_dt);
+    } else if (t_solver_name.find("rk2") != std::string::npos) {
+        return step_rk2(t_network, t_state, t_params, t_dt);
+    }
+    return step_rk4(t_network, t_state, t_params, t_dt);
+}
+
+/* Print a result and store it */
+void report(
+    std::vector<Benchmark::Record>& t_results,
+    Benchmark::Record t_record,
+    const Benchmark::Stats& t_stats,
+    const double& t_num_edge_visits,
+    const std::string& t_note = ""
+) {
+    t_record.set("time", t_stats);
+    t_record.set("edges_per_second", t_num_edge_visits / t_stats.median);
+    std::cout << std::left << std::setw(9) << t_record.get("benchmark") << " "
+              << std::setw(6) << t_record.get("family") << " N=" << std::setw(8)
+              << t_record.get("num_nodes") << " k=" << std::setw(6)
+              << t_record.get("mean_degree") << " " << std::setw(3)
+              << t_record.get("precision") << " " << std::setw(6)
+              << t_record.get("solver") << " " << std::setw(22)
+              << t_record.get("backend") << std::right << std::scientific
+              << std::setprecision(3) << " median " << t_stats.median << " s, p95 "
+              << t_stats.p95 << " s, " << t_num_edge_visits / t_stats.median
+              << " edges/s" << std::defaultfloat << (t_note.empty() ? "" : ", ")
+              << t_note << "\n";
+    t_results.emplace_back(t_record);
+}
+
+/* Parse of argument file and output of trajectories */
+template <typename T>
+void benchmark_io(
+    const BenchmarkOptions& t_options,
+    const Parameters<T>& t_params,
+    const Benchmark::Record& t_record,
+    std::vector<Benchmark::Record>& t_results
+) {
+    const int warmup = t_options.get_int("warmup");
+    const int repeats = t_options.get_int("repeats");
+    const Count num_nodes = t_params.phase.size();
+    const Count num_edges = t_params.weighted_edge_list.size();
+    const Count num_steps = t_params.dts.size();
+
+    const std::string arg_file_name =
+        "benchmark_args_" + std::to_string(std::random_device()()) + ".txt";
+    write_arg_file(arg_file_name, t_params);
+    const Count num_args = 5 * num_nodes + 3 * num_edges + num_steps;
+    const auto parse = Benchmark::measure(
+        [&]() {
+            const std::vector<T> args = read_arg_file(arg_file_name, num_args, (T)0);
+            const Parameters<T> parsed(args, num_nodes, num_edges, num_steps);
+            Benchmark::keep(parsed.phase);
+        },
+        warmup,
+        repeats
+    );
+    std::remove(arg_file_name.c_str());
+    report(
+        t_results,
+        Benchmark::Record(t_record).set("benchmark", "parse"),
+        parse,
+        num_edges
+    );
+
+    const std::vector<std::vector<T>> trajectories(
+        num_steps + 1, LinearAlgebra::flatten<T>({t_params.phase, t_params.dphase})
+    );
+    const auto output = Benchmark::measure(
+        [&]() {
+            std::ostringstream stream;
+            write_trajectories(stream, trajectories);
+        },
+        warmup,
+        repeats
+    );
+    report(
+        t_results,
+        Benchmark::Record(t_record).set("benchmark", "output"),
+        output,
+        num_edges
+    );
+}
+
+/* Reorder nodes, build network of the backend and call
+t_function(network, state, node_params) with threads of the backend */
+template <typename T, typename Function>
+void with_backend(
+    const Backend& t_backend,
+    Parameters<T> t_params,
+    Function&& t_function
+) {
+    const std::vector<Node> order = get_node_order(
+        t_backend.reorder, t_params.phase.size(), t_params.weighted_edge_list
+    );
+    if (not order.empty()) {
+        reorder(t_params, order);
+    }
+    const std::vector<std::vector<T>> state = {t_params.phase, t_params.dphase};
+    const std::vector<std::vector<T>> node_params = {
+        t_params.power, t_params.gamma, t_params.mass};
+
+    set_num_threads(t_backend.num_threads);
+    with_network(t_backend.network, t_params, [&](const auto& t_network) {
+        t_function(t_network, state, node_params);
+    });
+    set_num_threads(0);
+}
+
+/* Measured memory bandwidth and peak flops at the number of threads */
+template <typename T>
+const std::pair<double, double> get_ceiling(
+    const int& t_num_threads,
+    const Count& t_stream_size
+) {
+    static std::map<int, std::pair<double, double>> ceilings;
+    if (ceilings.find(t_num_threads) == ceilings.end()) {
+        set_num_threads(t_num_threads);
+        ceilings[t_num_threads] = {
+            get_stream_bandwidth(t_stream_size), get_peak_flops<T>()};
+        set_num_threads(0);
+    }
+    return ceilings.at(t_num_threads);
+}
+
+/* Single get_acceleration and single Runge-Kutta step
+Reorder and network construction are excluded
+Roofline: achieved bandwidth and flops of get_acceleration against the machine */
+template <typename T>
+void benchmark_kernel(
+    const BenchmarkOptions& t_options,
+    const Backend& t_backend,
+    const Parameters<T>& t_params,
+    const Benchmark::Record& t_record,
+    std::vector<Benchmark::Record>& t_results
+) {
+    const int warmup = t_options.get_int("warmup");
+    const int repeats = t_options.get_int("repeats");
+    const Count num_nodes = t_params.phase.size();
+    const double num_edges = t_params.weighted_edge_list.size();
+
+    std::pair<double, double> ceiling;
+    if (t_options.has("benchmarks", "roofline")) {
+        ceiling = get_ceiling<T>(t_backend.num_threads, t_options.get_int("stream"));
+    }
+
+    with_backend(
+        t_backend,
+        t_params,
+        [&](const auto& t_network, const auto& t_state, const auto& t_node_params) {
+            const auto kernel = Benchmark::measure(
+                [&]() {
+                    Benchmark::keep(
+                        get_acceleration(t_network, t_state, t_node_params)
+                    );
+                },
+                warmup,
+                repeats
+            );
+            const Benchmark::Record record =
+                Benchmark::Record(t_record).set("solver", "-");
+            if (t_options.has("benchmarks", "kernel")) {
+                report(
+                    t_results,
+                    Benchmark::Record(record).set("benchmark", "kernel"),
+                    kernel,
+                    num_edges
+                );
+            }
+
+            if (t_options.has("benchmarks", "roofline")) {
+                const KernelCost cost = get_kernel_cost(t_network, num_nodes);
+                const auto [bandwidth, peak] = ceiling;
+                const double achieved = cost.flops / kernel.median;
+                const double bound = std::min(peak, cost.get_intensity() * bandwidth);
+                std::ostringstream note;
+                note << std::setprecision(3) << cost.bytes / kernel.median / 1e9
+                     << " GB/s of " << bandwidth / 1e9 << ", " << achieved / 1e9
+                     << " GFLOP/s of " << peak / 1e9 << ", intensity "
+                     << cost.get_intensity() << ", " << 100.0 * achieved / bound
+                     << "% of roofline";
+                report(
+                    t_results,
+                    Benchmark::Record(record)
+                        .set("benchmark", "roofline")
+                        .set("bytes", cost.bytes)
+                        .set("flops", cost.flops)
+                        .set("intensity", cost.get_intensity())
+                        .set("bandwidth", cost.bytes / kernel.median)
+                        .set("flops_per_second", achieved)
+                        .set("stream_bandwidth", bandwidth)
+                        .set("peak_flops_per_second", peak)
+                        .set("roofline_fraction", achieved / bound),
+                    kernel,
+                    num_edges,
+                    note.str()
+                );
+            }
+
+            if (not t_options.has("benchmarks", "step")) {
+                return;
+            }
+            for (const std::string& solver_name : t_options.get_list("solvers")) {
+                using Network = std::decay_t<decltype(t_network)>;
+                if (needs_csr(solver_name) && not is_csr<Network>::value) {
+                    continue;
+                }
+                const auto step = Benchmark::measure(
+                    [&]() {
+                        Benchmark::keep(step_network(
+                            solver_name, t_network, t_state, t_node_params, (T)0.01
+                        )[0]);
+                    },
+                    warmup,
+                    repeats
+                );
+                report(
+                    t_results,
+                    Benchmark::Record(t_record)
+                        .set("benchmark", "step")
+                        .set("solver", solver_name),
+                    step,
+                    num_edges * get_num_stages(solver_name)
+                );
+            }
+        }
+    );
+}
+
+/* Time of get_acceleration over 1, 2, 4, ... threads
+strong: same network for every number of threads
+weak: number of nodes grows with number of threads */
+template <typename T>
+void benchmark_scaling(
+    const BenchmarkOptions& t_options,
+    const std::string& t_scaling,
+    Backend t_backend,
+    const Parameters<T>& t_params,
+    const Benchmark::Record& t_record,
+    pcg64& t_random_engine,
+    std::vector<Benchmark::Record>& t_results
+) {
+    const int warmup = t_options.get_int("warmup");
+    const int repeats = t_options.get_int("repeats");
+    const Count num_nodes = t_params.phase.size();
+
+    double single_thread_time = 0.0;
+    for (const int& num_threads : get_thread_counts()) {
+        Parameters<T> params = t_params;
+        if (t_scaling == "weak") {
+            const Graph graph = generate_graph(
+                t_record.get("family"),
+                num_threads * num_nodes,
+                std::stod(t_record.get("mean_degree")),
+                t_random_engine
+            );
+            params = Parameters<T>(graph, 0, (T)0.01, t_random_engine);
+        }
+        t_backend.num_threads = num_threads;
+
+        Benchmark::Stats kernel;
+        with_backend(
+            t_backend,
+            params,
+            [&](const auto& t_network, const auto& t_state, const auto& t_node_params) {
+                kernel = Benchmark::measure(
+                    [&]() {
+                        Benchmark::keep(
+                            get_acceleration(t_network, t_state, t_node_params)
+                        );
+                    },
+                    warmup,
+                    repeats
+                );
+            }
+        );
+        if (num_threads == 1) {
+            single_thread_time = kernel.median;
+        }
+
+        // Ideal: speedup of num_threads at strong, same time at weak
+        const double speedup = single_thread_time / kernel.median;
+        const double efficiency =
+            t_scaling == "strong" ? speedup / num_threads : speedup;
+        std::ostringstream note;
+        note << std::setprecision(3) << "speedup " << speedup << ", efficiency "
+             << efficiency;
+        report(
+            t_results,
+            Benchmark::Record(t_record)
+                .set("num_nodes", params.phase.size())
+                .set("num_edges", params.weighted_edge_list.size())
+                .set("backend", t_backend.to_string())
+                .set("threads", num_threads)
+                .set("benchmark", t_scaling)
+                .set("solver", "-")
+                .set("speedup", speedup)
+                .set("efficiency", efficiency),
+            kernel,
+            params.weighted_edge_list.size(),
+            note.str()
+        );
+    }
+}
+
+/* Full solve including reorder and network construction
+Last level cache misses per step are counted at an extra run */
+template <typename T>
+void benchmark_solve(
+    const BenchmarkOptions& t_options,
+    const Backend& t_backend,
+    const Parameters<T>& t_params,
+    const Benchmark::Record& t_record,
+    std::vector<Benchmark::Record>& t_results
+) {
+    const int warmup = t_options.get_int("warmup");
+    const int repeats = t_options.get_int("repeats");
+    const double num_edges = t_params.weighted_edge_list.size();
+    const Count num_steps = t_params.dts.size();
+
+    for (const std::string& solver_name : t_options.get_list("solvers")) {
+        if (needs_csr(solver_name) && t_backend.network != "csr") {
+            continue;  // Solved on csr whatever the backend: recorded at csr alone
+        }
+        const auto solve = Benchmark::measure(
+            [&]() {
+                Benchmark::keep(solve_backend(solver_name, t_backend, t_params).back());
+            },
+            warmup,
+            repeats
+        );
+
+#ifdef __linux__
+        PerfCounter counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#else
+        PerfCounter counter;
+#endif
+        counter.start();
+        Benchmark::keep(solve_backend(solver_name, t_backend, t_params).back());
+        counter.stop();
+        const double llc_misses = counter.is_available()
+                                      ? (double)counter.count() / num_steps
+                                      : std::nan("");
+
+        report(
+            t_results,
+            Benchmark::Record(t_record)
+                .set("benchmark", "solve")
+                .set("solver", solver_name)
+                .set("steps", num_steps)
+                .set("llc_misses_per_step", llc_misses),
+            solve,
+            num_edges * get_num_stages(solver_name) * num_steps
+        );
+    }
+}
+
+/* Point of accuracy benchmark: a solver at a precision and dt */
+struct AccuracyPoint {
+    Count result;  // Index of the record at results
+    double time;
+    double error;
+};
+
+/* Maximum absolute difference of final phase and dphase from reference */
+template <typename T>
+const double get_final_error(
+    const std::vector<std::vector<T>>& t_trajectories,
+    const std::vector<double>& t_reference
+) {
+    double error = 0.0;
+    for (Count i = 0; i < t_reference.size(); ++i) {
+        error = std::max(
+            error, std::abs((double)t_trajectories.back()[i] - t_reference[i])
+        );
+    }
+    return error;
+}
+
+/* Solve for the duration at each dt, solver and precision, then error against the
+reference of double precision rk4 at 1/8 of the smallest dt
+Time includes storing the (S+1, 2 * N) trajectory, as solve_backend returns it */
+template <typename T>
+void benchmark_accuracy_precision(
+    const BenchmarkOptions& t_options,
+    const Backend& t_backend,
+    const Parameters<double>& t_params,
+    const std::vector<double>& t_reference,
+    Benchmark::Record t_record,
+    std::vector<AccuracyPoint>& t_points,
+    std::vector<Benchmark::Record>& t_results,
+    const bool& t_mixed = false
+) {
+    const int warmup = t_options.get_int("warmup");
+    const int repeats = t_options.get_int("repeats");
+    const double duration = std::stod(t_options.values.at("duration"));
+    const double num_edges = t_params.weighted_edge_list.size();
+    if (t_mixed) {
+        t_record.set("precision", "mixed");
+    } else {
+        t_record.set("precision", 8 * (int)sizeof(T));
+    }
+
+    for (const std::string& dt_string : t_options.get_list("dts")) {
+        const double dt = std::stod(dt_string);
+        Parameters<T> params(t_params);
+        params.dts.assign(std::llround(duration / dt), (T)dt);
+
+        for (const std::string& solver_name : t_options.get_list("solvers")) {
+            if (t_mixed && not is_classic_runge_kutta(solver_name)) {
+                continue;  // Compensated update wraps classic Runge-Kutta alone
+            }
+            if (needs_csr(solver_name) && t_backend.network != "csr") {
+                continue;  // Solved on csr whatever the backend: recorded at csr alone
+            }
+            const std::string mode_name = solver_name + (t_mixed ? "_mixed" : "");
+            std::vector<std::vector<T>> trajectories;
+            const auto solve = Benchmark::measure(
+                [&]() { trajectories = solve_backend(mode_name, t_backend, params); },
+                warmup,
+                repeats
+            );
+            const double error = get_final_error(trajectories, t_reference);
+
+            std::ostringstream note;
+            note << std::setprecision(3) << "dt " << dt << ", error " << error;
+            Benchmark::Record record = Benchmark::Record(t_record)
+                                           .set("benchmark", "accuracy")
+                                           .set("solver", solver_name)
+                                           .set("dt", dt)
+                                           .set("steps", params.dts.size())
+                                           .set("error", error);
+            report(
+                t_results,
+                record,
+                solve,
+                num_edges * get_num_stages(solver_name) * params.dts.size(),
+                note.str()
+            );
+            t_points.push_back({t_results.size() - 1, solve.median, error});
+        }
+    }
+}
+
+/* Error and wall-clock time of every solver, precision and dt
+Pareto frontier: no other point is both faster and more accurate */
+void benchmark_accuracy(
+    const BenchmarkOptions& t_options,
+    const Graph& t_graph,
+    const Benchmark::Record& t_record,
+    pcg64& t_random_engine,
+    std::vector<Benchmark::Record>& t_results
+) {
+    const double duration = std::stod(t_options.values.at("duration"));
+    Parameters<double> params(t_graph, 0, 0.0, t_random_engine);
+
+    //* Reference: double precision rk4 at 1/8 of the smallest dt
+    double min_dt = std::numeric_limits<double>::infinity();
+    for (const std::string& dt : t_options.get_list("dts")) {
+        min_dt = std::min(min_dt, std::stod(dt));
+    }
+    // Stepped in place: trajectory of the reference would be too large to store
+    const double reference_dt = min_dt / 8.0;
+    const Count num_reference_steps = std::llround(duration / reference_dt);
+    const std::vector<std::vector<double>> node_params = {
+        params.power, params.gamma, params.mass};
+    std::vector<std::vector<double>> state = {params.phase, params.dphase};
+    for (Count step = 0; step < num_reference_steps; ++step) {
+        state = step_rk4(params.weighted_edge_list, state, node_params, reference_dt);
+    }
+    const std::vector<double> reference = LinearAlgebra::flatten(state);
+
+    std::vector<AccuracyPoint> points;
+    for (const std::string& backend_name : t_options.get_list("backends")) {
+        Backend backend = Backend::from_solver_name(backend_name, params);
+        if (backend_name.find("scatter") != std::string::npos) {
+            backend.network = "scatter";
+        }
+        const Benchmark::Record record =
+            Benchmark::Record(t_record).set("backend", backend.to_string());
+        for (const std::string& precision : t_options.get_list("precisions")) {
+            if (precision == "32") {
+                benchmark_accuracy_precision<float>(
+                    t_options, backend, params, reference, record, points, t_results
+                );
+            } else if (precision == "mixed") {
+                benchmark_accuracy_precision<float>(
+                    t_options,
+                    backend,
+                    params,
+                    reference,
+                    record,
+                    points,
+                    t_results,
+                    true
+                );
+            } else {
+                benchmark_accuracy_precision<double>(
+                    t_options, backend, params, reference, record, points, t_results
+                );
+            }
+        }
+    }
+
+    //* Pareto frontier
+    std::sort(points.begin(), points.end(), [](const auto& a, const auto& b) {
+        return a.time < b.time || (a.time == b.time && a.error < b.error);
+    });
+    const auto describe = [&](const AccuracyPoint& t_point) {
+        const Benchmark::Record& record = t_results[t_point.result];
+        const std::string precision = record.get("precision");
+        return record.get("solver") + " " +
+               (precision == "mixed" ? precision : precision + " bit") + ", " +
+               record.get("backend") + ", dt " + record.get("dt");
+    };
+    std::cout << "Pareto frontier of " << t_record.get("family")
+              << " N=" << t_record.get("num_nodes")
+              << " k=" << t_record.get("mean_degree") << "\n"
+              << std::scientific << std::setprecision(3);
+    double min_error = std::numeric_limits<double>::infinity();
+    for (const AccuracyPoint& point : points) {
+        const bool is_pareto = point.error < min_error;
+        t_results[point.result].set("pareto", (int)is_pareto);
+        if (is_pareto) {
+            min_error = point.error;
+            std::cout << "    " << describe(point) << ": " << point.time
+                      << " s, error " << point.error << "\n";
+        }
+    }
+
+    //* Wall-clock time at fixed error: fastest point reaching each tolerance
+    for (const std::string& tolerance : t_options.get_list("tolerances")) {
+        const auto point = std::find_if(
+            points.begin(),
+            points.end(),
+            [&](const AccuracyPoint& t_point) {
+                return t_point.error <= std::stod(tolerance);
+            }
+        );
+        std::cout << "    error <= " << tolerance << ": ";
+        if (point == points.end()) {
+            std::cout << "not reached\n";
+        } else {
+            std::cout << describe(*point) << ", " << point->time << " s\n";
+        }
+    }
+
+    //* Error at fixed wall-clock time: most accurate point within each budget
+    for (const std::string& budget : t_options.get_list("budgets")) {
+        const AccuracyPoint* best = nullptr;
+        for (const AccuracyPoint& point : points) {
+            if (point.time <= std::stod(budget) &&
+                (not best || point.error < best->error)) {
+                best = &point;
+            }
+        }
+        std::cout << "    time <= " << budget << " s: ";
+        if (not best) {
+            std::cout << "no solver is fast enough\n";
+        } else {
+            std::cout << describe(*best) << ", error " << best->error << "\n";
+        }
+    }
+    std::cout << std::defaultfloat;
+}
+
+template <typename T>
+void benchmark_precision(
+    const BenchmarkOptions& t_options,
+    const Graph& t_graph,
+    Benchmark::Record t_record,
+    pcg64& t_random_engine,
+    std::vector<Benchmark::Record>& t_results
+) {
+    const Parameters<T> params(
+        t_graph, t_options.get_int("steps"), (T)0.01, t_random_engine
+    );
+    t_record.set("precision", 8 * (int)sizeof(T));
+
+    if (t_options.has("benchmarks", "io")) {
+        benchmark_io(t_options, params, t_record, t_results);
+    }
+
+    for (const std::string& backend_name : t_options.get_list("backends")) {
+        Backend backend = Backend::from_solver_name(backend_name, params);
+        if (backend_name.find("scatter") != std::string::npos) {
+            backend.network = "scatter";
+        }
+        for (const std::string scaling : {"strong", "weak"}) {
+            if (t_options.has("benchmarks", scaling)) {
+                benchmark_scaling(
+                    t_options, scaling, backend, params, t_record, t_random_engine,
+                    t_results
+                );
+            }
+        }
+
+        for (const std::string& threads : t_options.get_list("threads")) {
+            backend.num_threads = std::stoi(threads);
+            Benchmark::Record record = t_record;
+            record.set("backend", backend.to_string());
+            record.set("threads", backend.num_threads);
+
+            if (t_options.has("benchmarks", "kernel") ||
+                t_options.has("benchmarks", "step") ||
+                t_options.has("benchmarks", "roofline")) {
+                benchmark_kernel(t_options, backend, params, record, t_results);
+            }
+            if (t_options.has("benchmarks", "solve")) {
+                benchmark_solve(t_options, backend, params, record, t_results);
+            }
+        }
+    }
+}
+
+}  // namespace Swing
+
+int main(int argc, char* argv[]) {
+    const Swing::BenchmarkOptions options(argc, argv);
+    const int warmup = options.get_int("warmup");
+    const int repeats = options.get_int("repeats");
+    pcg64 random_engine(options.get_int("seed"));
+
+    std::vector<Benchmark::Record> results;
+    for (const std::string& family : options.get_list("families")) {
+        for (const std::string& nodes : options.get_list("nodes")) {
+            for (const std::string& degree : options.get_list("degrees")) {
+                const Count num_nodes = std::stoull(nodes);
+                const double mean_degree = std::stod(degree);
+                const auto generate = [&]() {
+                    return Swing::generate_graph(
+                        family, num_nodes, mean_degree, random_engine
+                    );
+                };
+                const Graph graph = generate();
+
+                Benchmark::Record record;
+                record.set("family", family)
+                    .set("num_nodes", num_nodes)
+                    .set("mean_degree", mean_degree)
+                    .set("num_edges", graph.num_edges);
+
+                //* Graph generation
+                if (options.has("benchmarks", "generate")) {
+                    const auto generation = Benchmark::measure(
+                        [&]() { Benchmark::keep(generate().get_degrees()); },
+                        warmup,
+                        repeats
+                    );
+                    Swing::report(
+                        results,
+                        Benchmark::Record(record)
+                            .set("benchmark", "generate")
+                            .set("precision", "-")
+                            .set("solver", "-")
+                            .set("backend", "-"),
+                        generation,
+                        graph.num_edges
+                    );
+                }
+
+                //* Error against cost of solvers, precisions and dts
+                if (options.has("benchmarks", "accuracy")) {
+                    Swing::benchmark_accuracy(
+                        options, graph, record, random_engine, results
+                    );
+                }
+
+                for (const std::string& precision : options.get_list("precisions")) {
+                    if (precision == "mixed") {
+                        continue;  // Only at accuracy benchmark
+                    } else if (precision == "32") {
+                        Swing::benchmark_precision<float>(
+                            options, graph, record, random_engine, results
+                        );
+                    } else {
+                        Swing::benchmark_precision<double>(
+                            options, graph, record, random_engine, results
+                        );
+                    }
+                }
+            }
+        }
+    }
+
+    //* Machine readable report
+    const std::string json_file_name = options.values.at("json");
+    if (not json_file_name.empty()) {
+        Benchmark::Record machine;
+        machine.set("cpu", Swing::get_cpu_model())
+            .set("max_threads", Swing::get_max_threads())
+            .set("compiler", __VERSION__);
+        std::ofstream json_file(json_file_name);
+        Benchmark::write_json(json_file, machine, results);
+    }
+
+    SWING_PROFILE_REPORT();
+    return 0;
+}
@@ -0,0 +1,923 @@
+/*
+Randomized differential test of get_acceleration against get_acceleration_original
+
+Compile: g++ -O2 -fopenmp -std=c++17 -o differential.out main_differential.cpp
+Usage: ./differential.out [--option value]
+    --trials        number of random networks per precision (default: 50)
+    --nodes         maximum number of nodes (default: 1000)
+    --precisions    32, 64 (default: 32,64)
+    --tolerance     allowed error in units of epsilon times error scale (default: 16)
+    --steps         number of rk4 steps of solve check (default: 5)
+    --seed          random seed (default: 0)
+
+Each trial draws a network of er, ba or nearly complete er family with unit, random
+or mixed weights, uniform or random node parameters, and phases in [-pi, pi] or in
+[-100, 100] to mimic long runs. Every kernel variant, i.e., network (scatter, csr,
+csr without uniform node parameters, csr with double sums, dense, meanfield) x
+reorder (none, rcm, degree, gorder) x threads (1, 2, 4, ... max), is compared with
+the oracle at the same precision.
+
+Rounding error of acceleration of node i is bounded by its error scale
+    s_i = (|P_i| + |gamma_i * omega_i| + (1 + max |theta|) * sum_j |K_ij|) / m_i
+where mean-field adds N * |K| of the complete graph to sum_j |K_ij|.
+
+Checks
+- error: |a_i - oracle_i| <= tolerance * epsilon * s_i for every node
+- net interaction: sum_i (m_i * a_i - P_i + gamma_i * omega_i) vanishes for
+  symmetric weights, within tolerance * epsilon * sum_i m_i * s_i
+- threads: acceleration is bitwise identical at every number of threads
+- solve: final state of rk4 solve_backend, also at mixed precision and rotating
+  frame, against solve_rk4_original
+- order: at double precision, observed order log2(e1 / e2) of final state errors
+  against rk4 at 1/32 of dt, with dt halved from 8 steps of 0.1 / max rate.
+  lsrk3 at order 3, lsrk4, ab4, abm4, multirate at 4, bdf2, verlet, leapfrog,
+  strang at 2. bdf2, ab4, abm4 also with alternating dts of ratio 2, multirate
+  with overdamped fast nodes against rk4 at 1/256 of dt. The deficit of the
+  expected order, at most 0.5, is reported as max error
+- steady: residual max_i |P'_i + sum_j K_ij sin(theta_j - theta_i)| of solve_steady
+  on the network connected by a path, with |K| and P / N, within 1e3 * epsilon *
+  scale * (1 + max |theta|). An overloaded node exits with no phase-locked state
+- stability: analyze_backend on a ring of 100 nodes and a two-node saddle against
+  closed forms, within 2 * sqrt(epsilon) * max |mu|, and their unstable modes
+ULP distance and relative error are reported as statistics only, over nodes whose
+acceleration is above 1e-3 * s_i: they are meaningless where interactions cancel.
+
+Exit status: 0 if every check passes, 1 otherwise
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ba.hpp"
+#include "backend.hpp"
+#include "benchmark.hpp"
+#include "er.hpp"
+#include "parameters.hpp"
+#include "pcg_random.hpp"
+#include "reorder.hpp"
+#include "solver.hpp"
+#include "solver_original.hpp"
+
+namespace Swing {
+
+struct DifferentialOptions {
+    std::map<std::string, std::string> values = {
+        {"trials", "50"},
+        {"nodes", "1000"},
+        {"precisions", "32,64"},
+        {"tolerance", "16"},
+        {"steps", "5"},
+        {"seed", "0"},
+    };
+
+    DifferentialOptions(int argc, char* argv[]) {
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const std::string key = std::string(argv[i]).substr(2);
+            if (values.find(key) == values.end()) {
+                std::cout << "Unknown option " << argv[i] << "\n";
+                exit(1);
+            }
+            values[key] = argv[i + 1];
+        }
+    }
+
+    const int get_int(const std::string& t_key) const {
+        return std::stoi(values.at(t_key));
+    }
+    const double get_double(const std::string& t_key) const {
+        return std::stod(values.at(t_key));
+    }
+};
+
+/* Error statistics of a kernel variant over every trial */
+struct ErrorStats {
+    std::vector<double> ulps;
+    double max_relative = 0.0;
+    double max_normalized = 0.0;  // |a - oracle| / (epsilon * s)
+    Count num_checks = 0;
+    Count num_failures = 0;
+};
+
+/* Distance of two values in units in the last place */
+template <typename T>
+const double get_ulp_distance(const T& t_value1, const T& t_value2) {
+    using Int = std::conditional_t<sizeof(T) == 4, int32_t, int64_t>;
+    const auto to_ordered = [](const T& t_value) {
+        Int bits;
+        std::memcpy(&bits, &t_value, sizeof(T));
+        return bits < 0 ? std::numeric_limits<Int>::min() - bits : bits;
+    };
+    return std::fabs((double)to_ordered(t_value1) - (double)to_ordered(t_value2));
+}
+
+/* Random network and state of a trial, at double precision */
+Parameters<double> generate_trial(const Count& t_max_nodes, pcg64& t_random_engine) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const auto pick = [&](const int& t_num_choices) {
+        std::uniform_int_distribution<int> choice(0, t_num_choices - 1);
+        return choice(t_random_engine);
+    };
+
+    //* Graph: number of nodes is log-uniform in [2, t_max_nodes]
+    const Count num_nodes =
+        std::max((Count)2, (Count)std::exp(uniform(t_random_engine) *
+                                           std::log((double)t_max_nodes)));
+    const int family = pick(3);
+    const double mean_degree =
+        family == 2
+            ? 0.9 * (num_nodes - 1)
+            : std::min(num_nodes - 1.0, 1.0 + 15.0 * uniform(t_random_engine));
+    const Graph graph =
+        family == 1
+            ? BA::generate_by_degree(num_nodes, mean_degree, t_random_engine)
+            : ER::generate_by_degree(num_nodes, mean_degree, t_random_engine);
+    Parameters<double> params(graph, 0, 0.0, t_random_engine);
+
+    //* Weights: unit, random including negative, or mostly unit
+    const int weight_mode = pick(3);
+    for (WeightedEdge<double>& weighted_edge : params.weighted_edge_list) {
+        if (weight_mode == 1 || (weight_mode == 2 && uniform(t_random_engine) < 0.3)) {
+            weighted_edge.weight = -1.0 + 3.0 * uniform(t_random_engine);
+        }
+    }
+
+    //* Node parameters: uniform or random
+    if (pick(2)) {
+        const double power = -1.0 + 2.0 * uniform(t_random_engine);
+        const double gamma = uniform(t_random_engine);
+        const double mass = 0.5 + 1.5 * uniform(t_random_engine);
+        params.power.assign(num_nodes, power);
+        params.gamma.assign(num_nodes, gamma);
+        params.mass.assign(num_nodes, mass);
+    } else {
+        for (Node node = 0; node < num_nodes; ++node) {
+            params.power[node] = -1.0 + 2.0 * uniform(t_random_engine);
+            params.gamma[node] = uniform(t_random_engine);
+            params.mass[node] = 0.5 + 1.5 * uniform(t_random_engine);
+        }
+    }
+
+    //* State: phase in [-pi, pi] or [-100, 100]
+    const double max_phase = pick(2) ? M_PI : 100.0;
+    for (Node node = 0; node < num_nodes; ++node) {
+        params.phase[node] = max_phase * (-1.0 + 2.0 * uniform(t_random_engine));
+        params.dphase[node] = -1.0 + 2.0 * uniform(t_random_engine);
+    }
+    return params;
+}
+
+/* Error scale s_i of each node, see top of this file */
+template <typename T>
+std::vector<double> get_error_scale(
+    const Parameters<T>& t_params,
+    const double& t_complete_coupling
+) {
+    const Count num_nodes = t_params.phase.size();
+    double max_phase = 0.0;
+    for (const T& phase : t_params.phase) {
+        max_phase = std::max(max_phase, std::fabs((double)phase));
+    }
+
+    std::vector<double> weight_sum(num_nodes, num_nodes * t_complete_coupling);
+    for (const WeightedEdge<T>& weighted_edge : t_params.weighted_edge_list) {
+        weight_sum[weighted_edge.node1] += std::fabs((double)weighted_edge.weight);
+        weight_sum[weighted_edge.node2] += std::fabs((double)weighted_edge.weight);
+    }
+
+    std::vector<double> scale(num_nodes);
+    for (Node node = 0; node < num_nodes; ++node) {
+        scale[node] = (std::fabs((double)t_params.power[node]) +
+                       std::fabs((double)t_params.gamma[node] * t_params.dphase[node]) +
+                       (1.0 + max_phase) * weight_sum[node]) /
+                      t_params.mass[node];
+    }
+    return scale;
+}
+
+/* Acceleration of a kernel variant, at the original node ids
+"csr_general" is csr forced to stream node parameters, "csr_mixed" is csr with
+per-node sums at double precision */
+template <typename T>
+std::vector<T> get_acceleration_variant(
+    const Backend& t_backend,
+    Parameters<T> t_params
+) {
+    set_num_threads(t_backend.num_threads);
+    const Count num_nodes = t_params.phase.size();
+    const std::vector<Node> order = get_node_order(
+        t_backend.reorder, num_nodes, t_params.weighted_edge_list
+    );
+    if (not order.empty()) {
+        reorder(t_params, order);
+    }
+
+    std::vector<T> acceleration;
+    const std::vector<std::vector<T>> state = {t_params.phase, t_params.dphase};
+    const std::vector<std::vector<T>> node_params = {
+        t_params.power, t_params.gamma, t_params.mass};
+    if (t_backend.network == "csr_general") {
+        const CSR<T> csr(num_nodes, t_params.weighted_edge_list);
+        acceleration = get_acceleration(csr, state, node_params);
+    } else if (t_backend.network == "csr_mixed") {
+        CSR<T> csr(num_nodes, t_params.weighted_edge_list);
+        csr.uniform_node_params = t_params.is_uniform_node_params();
+        csr.double_sums = true;
+        acceleration = get_acceleration(csr, state, node_params);
+    } else {
+        with_network(t_backend.network, t_params, [&](const auto& t_network) {
+            acceleration = get_acceleration(t_network, state, node_params);
+        });
+    }
+
+    if (order.empty()) {
+        return acceleration;
+    }
+    std::vector<T> restored(num_nodes);
+    for (Node node = 0; node < num_nodes; ++node) {
+        restored[order[node]] = acceleration[node];
+    }
+    return restored;
+}
+
+/* Print a failed check of a trial */
+void report_failure(
+    const int& t_precision,
+    const int& t_trial,
+    const std::string& t_check,
+    const std::string& t_variant,
+    const double& t_value,
+    const double& t_bound
+) {
+    std::cout << "FAIL " << t_precision << " bit, trial " << t_trial << ", "
+              << t_check << " of " << t_variant << ": " << std::scientific
+              << std::setprecision(3) << t_value << " > " << t_bound
+              << std::defaultfloat << "\n";
+}
+
+/* Compare every kernel variant of a trial with the oracle. Return number of failed
+checks */
+template <typename T>
+Count check_trial(
+    const DifferentialOptions& t_options,
+    const int& t_trial,
+    const Parameters<T>& t_params,
+    std::map<std::string, ErrorStats>& t_stats
+) {
+    constexpr int precision = 8 * sizeof(T);
+    const double epsilon = std::numeric_limits<T>::epsilon();
+    const double tolerance = t_options.get_double("tolerance");
+    const Count num_nodes = t_params.phase.size();
+    const std::vector<std::vector<T>> state = {t_params.phase, t_params.dphase};
+    const std::vector<std::vector<T>> node_params = {
+        t_params.power, t_params.gamma, t_params.mass};
+    const std::vector<T> oracle =
+        get_acceleration_original(t_params.weighted_edge_list, state, node_params);
+    const double complete_coupling =
+        std::fabs((double)MeanField<T>::get_coupling(t_params.weighted_edge_list));
+    Count num_failures = 0;
+
+    std::vector<std::string> networks = {
+        "scatter", "csr", "csr_mixed", "dense", "meanfield"};
+    if (t_params.is_uniform_node_params()) {
+        networks.emplace_back("csr_general");
+    }
+    for (const std::string& network : networks) {
+        const std::vector<double> scale = get_error_scale(
+            t_params, network == "meanfield" ? complete_coupling : 0.0
+        );
+        double scale_sum = 0.0;
+        for (Node node = 0; node < num_nodes; ++node) {
+            scale_sum += t_params.mass[node] * scale[node];
+        }
+
+        for (const std::string reorder : {"", "rcm", "degree", "gorder"}) {
+            std::vector<T> first_acceleration;
+            for (const int& num_threads : get_thread_counts()) {
+                const Backend backend(network, reorder, num_threads);
+                const std::string variant = backend.to_string();
+                ErrorStats& stats = t_stats[variant];
+                const std::vector<T> acceleration =
+                    get_acceleration_variant(backend, t_params);
+                const Count previous_failures = stats.num_failures;
+
+                //* Error against oracle
+                double max_normalized = 0.0, net_interaction = 0.0;
+                for (Node node = 0; node < num_nodes; ++node) {
+                    const double error =
+                        std::fabs((double)acceleration[node] - (double)oracle[node]);
+                    max_normalized =
+                        std::max(max_normalized, error / (epsilon * scale[node]));
+                    if (std::fabs((double)oracle[node]) > 1e-3 * scale[node]) {
+                        stats.ulps.emplace_back(
+                            get_ulp_distance(acceleration[node], oracle[node])
+                        );
+                        stats.max_relative = std::max(
+                            stats.max_relative,
+                            error / std::fabs((double)oracle[node])
+                        );
+                    }
+                    net_interaction +=
+                        (double)t_params.mass[node] * acceleration[node] -
+                        t_params.power[node] +
+                        (double)t_params.gamma[node] * t_params.dphase[node];
+                }
+                stats.max_normalized = std::max(stats.max_normalized, max_normalized);
+                stats.num_checks += 3;
+                if (not(max_normalized <= tolerance)) {
+                    report_failure(
+                        precision, t_trial, "error", variant, max_normalized, tolerance
+                    );
+                    ++stats.num_failures;
+                }
+
+                //* Net interaction of symmetric weights
+                const double net_bound = tolerance * epsilon * scale_sum;
+                if (not(std::fabs(net_interaction) <= net_bound)) {
+                    report_failure(
+                        precision,
+                        t_trial,
+                        "net interaction",
+                        variant,
+                        std::fabs(net_interaction),
+                        net_bound
+                    );
+                    ++stats.num_failures;
+                }
+
+                //* Independent of number of threads
+                if (first_acceleration.empty()) {
+                    first_acceleration = acceleration;
+                } else if (acceleration != first_acceleration) {
+                    double max_difference = 0.0;
+                    for (Node node = 0; node < num_nodes; ++node) {
+                        max_difference = std::max(
+                            max_difference,
+                            std::fabs(
+                                (double)acceleration[node] - first_acceleration[node]
+                            )
+                        );
+                    }
+                    report_failure(
+                        precision, t_trial, "threads", variant, max_difference, 0.0
+                    );
+                    ++stats.num_failures;
+                }
+                num_failures += stats.num_failures - previous_failures;
+            }
+        }
+    }
+    return num_failures;
+}
+
+/* Largest rate of local dynamics, max(gamma / m, sqrt(sum_j |K_ij| / m)) over
+nodes, and at least 1 for the drive of power and initial velocity */
+const double get_max_rate(const Parameters<double>& t_params) {
+    const Count num_nodes = t_params.phase.size();
+    std::vector<double> coupling(num_nodes, 0.0);
+    for (const WeightedEdge<double>& weighted_edge : t_params.weighted_edge_list) {
+        coupling[weighted_edge.node1] += std::fabs(weighted_edge.weight);
+        coupling[weighted_edge.node2] += std::fabs(weighted_edge.weight);
+    }
+    double max_rate = 1.0;
+    for (Node node = 0; node < num_nodes; ++node) {
+        const double mass = t_params.mass[node];
+        max_rate = std::max(
+            {max_rate,
+             std::fabs(t_params.gamma[node]) / mass,
+             std::sqrt(coupling[node] / mass)}
+        );
+    }
+    return max_rate;
+}
+
+/* dts halved and repeated twice: same duration and ratios of consecutive dts, so
+that error constants of variable step methods are kept */
+std::vector<double> refine_dts(const std::vector<double>& t_dts) {
+    std::vector<double> refined;
+    refined.reserve(2 * t_dts.size());
+    for (int repeat = 0; repeat < 2; ++repeat) {
+        for (const double& dt : t_dts) {
+            refined.emplace_back(0.5 * dt);
+        }
+    }
+    return refined;
+}
+
+/* Maximum absolute difference of two final states */
+const double get_final_error(
+    const std::vector<double>& t_final_state,
+    const std::vector<double>& t_reference
+) {
+    double error = 0.0;
+    for (Count idx = 0; idx < t_reference.size(); ++idx) {
+        error = std::max(error, std::fabs(t_final_state[idx] - t_reference[idx]));
+    }
+    return error;
+}
+
+/* Observed convergence order of a solver on csr, log2(e1 / e2) of final state
+errors at dts refined once and twice, against rk4 at dts refined
+t_reference_levels times. Deficit of the expected order is kept as error. Errors
+at rounding pass. Return 1 if the deficit exceeds order_margin */
+Count check_order(
+    const int& t_trial,
+    const std::string& t_variant,
+    const std::string& t_solver_name,
+    const double& t_order,
+    Parameters<double> t_params,
+    std::map<std::string, ErrorStats>& t_stats,
+    const int& t_reference_levels = 5
+) {
+    constexpr double order_margin = 0.5;
+    const Backend backend("csr", "", 0);
+    ErrorStats& stats = t_stats["order " + t_variant];
+
+    std::vector<double> errors;
+    Parameters<double> reference_params(t_params);
+    for (int level = 0; level < t_reference_levels; ++level) {
+        reference_params.dts = refine_dts(reference_params.dts);
+    }
+    const std::vector<double> reference =
+        solve_backend("rk4", backend, reference_params).back();
+    for (int level = 0; level < 2; ++level) {
+        t_params.dts = refine_dts(t_params.dts);
+        errors.emplace_back(get_final_error(
+            solve_backend(t_solver_name, backend, t_params).back(), reference
+        ));
+    }
+
+    double max_state = 1.0;
+    for (const double& value : reference) {
+        max_state = std::max(max_state, std::fabs(value));
+    }
+    const double rounding = 1e3 * std::numeric_limits<double>::epsilon() * max_state;
+    const double deficit =
+        errors[1] <= rounding ? 0.0 : t_order - std::log2(errors[0] / errors[1]);
+    stats.max_normalized = std::max(stats.max_normalized, deficit);
+    ++stats.num_checks;
+    if (not(deficit <= order_margin)) {
+        report_failure(64, t_trial, "order", t_variant, deficit, order_margin);
+        ++stats.num_failures;
+        return 1;
+    }
+    return 0;
+}
+
+/* Compare final state of rk4 solve of every backend and precision mode with
+solve_rk4_original. Return number of failed checks */
+template <typename T>
+Count check_solve(
+    const DifferentialOptions& t_options,
+    const int& t_trial,
+    const Parameters<T>& t_params,
+    std::map<std::string, ErrorStats>& t_stats
+) {
+    constexpr int precision = 8 * sizeof(T);
+    const double epsilon = std::numeric_limits<T>::epsilon();
+    const double tolerance = t_options.get_double("tolerance");
+    const Count num_nodes = t_params.phase.size();
+    const Count num_steps = t_params.dts.size();
+    const std::vector<T> oracle = solve_rk4_original(
+        t_params.weighted_edge_list,
+        {t_params.phase, t_params.dphase},
+        {t_params.power, t_params.gamma, t_params.mass},
+        t_params.dts
+    ).back();
+    const double complete_coupling =
+        std::fabs((double)MeanField<T>::get_coupling(t_params.weighted_edge_list));
+    Count num_failures = 0;
+
+    // Rotating frame adds and subtracts the mean frequency
+    double power_sum = 0.0, gamma_sum = 0.0;
+    for (Node node = 0; node < num_nodes; ++node) {
+        power_sum += t_params.power[node];
+        gamma_sum += t_params.gamma[node];
+    }
+    const double frequency = gamma_sum != 0.0 ? std::fabs(power_sum / gamma_sum) : 0.0;
+
+    for (const std::string network : {"scatter", "csr", "dense", "meanfield"}) {
+        const std::vector<double> scale = get_error_scale(
+            t_params, network == std::string("meanfield") ? complete_coupling : 0.0
+        );
+        for (const std::string reorder : {"", "rcm", "degree", "gorder"}) {
+            for (const std::string solver_name : {"rk4", "rk4_mixed", "rk4_rotating"}) {
+                const Backend backend(network, reorder, 0);
+                const std::string variant = solver_name + " " + backend.to_string();
+                ErrorStats& stats = t_stats[variant];
+                const std::vector<T> final_state =
+                    solve_backend(solver_name, backend, t_params).back();
+
+                // Rounding of each step accumulates on state and on acceleration
+                double max_normalized = 0.0;
+                for (Node node = 0; node < num_nodes; ++node) {
+                    const double node_scale =
+                        num_steps * (std::fabs((double)oracle[node]) +
+                                     std::fabs((double)oracle[num_nodes + node]) +
+                                     scale[node] + frequency);
+                    for (const Node& idx : {node, num_nodes + node}) {
+                        const double error =
+                            std::fabs((double)final_state[idx] - (double)oracle[idx]);
+                        max_normalized =
+                            std::max(max_normalized, error / (epsilon * node_scale));
+                    }
+                }
+                stats.max_normalized = std::max(stats.max_normalized, max_normalized);
+                ++stats.num_checks;
+                if (not(max_normalized <= tolerance)) {
+                    report_failure(
+                        precision, t_trial, "solve", variant, max_normalized, tolerance
+                    );
+                    ++stats.num_failures;
+                    ++num_failures;
+                }
+            }
+        }
+    }
+
+    //* Convergence order at double precision, 8 steps of 0.1 / rate at coarsest
+    // Alternating dts of ratio 2 check the variable step coefficients of bdf2
+    // and Adams methods
+    if constexpr (std::is_same_v<T, double>) {
+        const double dt = 0.1 / get_max_rate(t_params);
+        Parameters<double> constant_params(t_params), alternating_params(t_params);
+        constant_params.dts.assign(8, dt);
+        alternating_params.dts.clear();
+        for (int step = 0; step < 8; ++step) {
+            alternating_params.dts.emplace_back(step % 2 ? 0.5 * dt : dt);
+        }
+        const std::vector<std::pair<std::string, double>> orders = {
+            {"bdf2", 2.0},
+            {"lsrk3", 3.0},
+            {"lsrk4", 4.0},
+            {"ab4", 4.0},
+            {"abm4", 4.0},
+            {"verlet", 2.0},
+            {"leapfrog", 2.0},
+            {"strang", 2.0}};
+        for (const auto& [solver_name, order] : orders) {
+            num_failures += check_order(
+                t_trial, solver_name, solver_name, order, constant_params, t_stats
+            );
+        }
+        for (const std::string solver_name : {"bdf2", "ab4", "abm4"}) {
+            const double order = solver_name == "bdf2" ? 2.0 : 4.0;
+            num_failures += check_order(
+                t_trial,
+                solver_name + " variable",
+                solver_name,
+                order,
+                alternating_params,
+                t_stats
+            );
+        }
+
+        // Multirate: every 8th node is overdamped at rate 200 / dt, fast at every
+        // level. Its substeps keep a size of about dt / 200 as dt is halved, so that
+        // their error must stay below that of slow nodes: damping of the fast node
+        // outweighs its coupling by 1000 dt and it starts at zero acceleration,
+        // without transient. Reference at dt / 256 resolves the fast rate
+        Parameters<double> multirate_params(constant_params);
+        const double fast_rate = 200.0 / dt;
+        std::vector<double> coupling(num_nodes, 0.0);
+        for (const WeightedEdge<double>& edge : multirate_params.weighted_edge_list) {
+            coupling[edge.node1] += std::fabs(edge.weight);
+            coupling[edge.node2] += std::fabs(edge.weight);
+        }
+        for (Node node = 0; node < num_nodes; node += 8) {
+            multirate_params.gamma[node] = std::max(1.0, 1000.0 * dt * coupling[node]);
+            multirate_params.mass[node] = multirate_params.gamma[node] / fast_rate;
+            multirate_params.dphase[node] = 0.0;
+        }
+        const std::vector<double> acceleration = get_acceleration_original(
+            multirate_params.weighted_edge_list,
+            {multirate_params.phase, multirate_params.dphase},
+            {multirate_params.power, multirate_params.gamma, multirate_params.mass}
+        );
+        for (Node node = 0; node < num_nodes; node += 8) {
+            multirate_params.dphase[node] = multirate_params.mass[node] *
+                                            acceleration[node] /
+                                            multirate_params.gamma[node];
+        }
+        num_failures += check_order(
+            t_trial, "multirate", "multirate", 4.0, multirate_params, t_stats, 8
+        );
+    }
+    return num_failures;
+}
+
+/* Phase-locked state of solve_steady on the trial network made connected by a path
+of unit edges, with |weights| and powers small enough to lock. Its residual
+max_i |P'_i + sum_j K_ij sin(theta_j - theta_i)| is kept in units of epsilon *
+scale * (1 + max |theta|), scale as at solve_steady. Then a node overloaded beyond
+its coupling must exit with "no phase-locked state", at a child process. Return
+number of failed checks */
+template <typename T>
+Count check_steady(
+    const int& t_trial,
+    const Parameters<T>& t_params,
+    std::map<std::string, ErrorStats>& t_stats
+) {
+    constexpr int precision = 8 * sizeof(T);
+    constexpr double newton_tolerance = 1e3;  // of solve_steady
+    const double epsilon = std::numeric_limits<T>::epsilon();
+    const Backend backend("csr", "", 0);
+    const Count num_nodes = t_params.phase.size();
+    Count num_failures = 0;
+
+    //* Connected network: any cut carries sum |P| < 1 of the path edge
+    Parameters<T> params(t_params);
+    for (WeightedEdge<T>& edge : params.weighted_edge_list) {
+        edge.weight = std::fabs(edge.weight);
+    }
+    for (Node node = 0; node + 1 < num_nodes; ++node) {
+        params.weighted_edge_list.emplace_back(node, node + 1, 1.0);
+    }
+    for (Node node = 0; node < num_nodes; ++node) {
+        params.power[node] = t_params.power[node] / num_nodes;
+    }
+    params.dts = {0.0};
+
+    //* Residual at the rotating frame, at double precision
+    double power_sum = 0.0, gamma_sum = 0.0;
+    for (Node node = 0; node < num_nodes; ++node) {
+        power_sum += params.power[node];
+        gamma_sum += params.gamma[node];
+    }
+    const double frequency = gamma_sum != 0.0 ? power_sum / gamma_sum : 0.0;
+    const std::vector<T> steady = solve_backend("steady", backend, params).back();
+    std::vector<double> residual(num_nodes), coupling(num_nodes, 0.0);
+    for (Node node = 0; node < num_nodes; ++node) {
+        residual[node] = params.power[node] - params.gamma[node] * frequency;
+    }
+    for (const WeightedEdge<T>& edge : params.weighted_edge_list) {
+        const double weight = edge.weight;
+        const double interaction =
+            weight * std::sin((double)steady[edge.node2] - (double)steady[edge.node1]);
+        residual[edge.node1] += interaction;
+        residual[edge.node2] -= interaction;
+        coupling[edge.node1] += weight;
+        coupling[edge.node2] += weight;
+    }
+    double scale = std::fabs(power_sum), max_residual = 0.0, max_phase = 0.0;
+    for (Node node = 0; node < num_nodes; ++node) {
+        const double needed =
+            std::fabs(params.power[node] - params.gamma[node] * frequency);
+        scale = std::max(scale, needed + coupling[node]);
+        max_residual = std::max(max_residual, std::fabs(residual[node]));
+        max_phase = std::max(max_phase, std::fabs((double)steady[node]));
+    }
+    const double normalized = max_residual / (epsilon * scale * (1.0 + max_phase));
+    ErrorStats& stats = t_stats["steady residual"];
+    stats.max_normalized = std::max(stats.max_normalized, normalized);
+    ++stats.num_checks;
+    if (not(normalized <= newton_tolerance)) {
+        report_failure(
+            precision, t_trial, "steady", "residual", normalized, newton_tolerance
+        );
+        ++stats.num_failures;
+        ++num_failures;
+    }
+
+    //* Node 0 needs power twice its coupling, node 1 takes it: Omega = 0
+    Parameters<T> overloaded_params(params);
+    overloaded_params.power.assign(num_nodes, 0.0);
+    overloaded_params.power[0] = 2.0 * (1.0 + coupling[0]);
+    overloaded_params.power[1] = -overloaded_params.power[0];
+
+    // solve_steady exits there: stderr of a child process through a pipe. Output is
+    // flushed first, not to be flushed again at exit of the child
+    int pipe_ends[2];
+    std::string message;
+    int status = 0;
+    std::cout.flush();
+    if (pipe(pipe_ends) == 0) {
+        const pid_t pid = fork();
+        if (pid == 0) {
+            close(pipe_ends[0]);
+            dup2(pipe_ends[1], STDERR_FILENO);
+            solve_backend("steady", backend, overloaded_params);
+            _exit(0);
+        }
+        close(pipe_ends[1]);
+        char buffer[256];
+        ssize_t length;
+        while ((length = read(pipe_ends[0], buffer, sizeof(buffer))) > 0) {
+            message.append(buffer, length);
+        }
+        close(pipe_ends[0]);
+        if (pid < 0 || waitpid(pid, &status, 0) != pid) {
+            status = 0;
+        }
+    }
+    const bool is_reported =
+        WIFEXITED(status) && WEXITSTATUS(status) == 1 &&
+        message.find("no phase-locked state") != std::string::npos;
+    ErrorStats& overloaded_stats = t_stats["steady overloaded"];
+    ++overloaded_stats.num_checks;
+    if (not is_reported) {
+        std::cout << "FAIL " << precision << " bit, trial " << t_trial
+                  << ", steady of overloaded: no exit with no phase-locked state\n";
+        ++overloaded_stats.num_failures;
+        ++num_failures;
+    }
+    return num_failures;
+}
+
+/* Stability of networks of closed form modes, at phases of unit masses and weights.
+Ring of 100 nodes at equal phases, gamma 0.1: L_cos is the graph Laplacian, of
+mu_min = 2 (1 - cos(2 pi / N)), mu_max = 4 and zeta_min = 0.1 / (2 sqrt(4)). Every
+mode is underdamped at decay -0.05, and the frequency of the least stiff one,
+sqrt(mu_min - 0.05^2), is reported at every reorder. So is the frequency of a
+random 40-node network of the same damping, as without reorder. Two nodes at the
+saddle of P = -+0.5, dtheta = pi - asin(0.5), gamma 0.2: one mode of
+mu = 2 cos(dtheta) = -sqrt(3), growing at lambda = -0.1 + sqrt(0.01 + sqrt(3)).
+Errors are kept in units of the Lanczos tolerance sqrt(epsilon) * max |mu|. Return
+number of failed checks */
+template <typename T>
+Count check_stability(std::map<std::string, ErrorStats>& t_stats) {
+    constexpr int precision = 8 * sizeof(T);
+    constexpr double margin = 2.0;  // Ritz value error of converged pairs is 1
+    const double unit = std::sqrt(std::numeric_limits<T>::epsilon());
+    const Backend backend("csr", "", 0);
+    Count num_failures = 0;
+
+    const auto report = [&](ErrorStats& t_stats,
+                            const std::string& t_variant,
+                            const double& t_value,
+                            const double& t_expected) {
+        std::cout << "FAIL " << precision << " bit, stability of " << t_variant << ": "
+                  << std::setprecision(12) << t_value << " against " << t_expected
+                  << std::setprecision(6) << "\n";
+        ++t_stats.num_failures;
+        ++num_failures;
+    };
+    const auto check = [&](const std::string& t_variant,
+                           const double& t_value,
+                           const double& t_expected,
+                           const double& t_scale) {
+        const double normalized = std::fabs(t_value - t_expected) / (unit * t_scale);
+        ErrorStats& stats = t_stats["stability " + t_variant];
+        stats.max_normalized = std::max(stats.max_normalized, normalized);
+        ++stats.num_checks;
+        if (not(normalized <= margin)) {
+            report(stats, t_variant, t_value, t_expected);
+        }
+    };
+    const auto check_exact = [&](const std::string& t_variant,
+                                 const double& t_value,
+                                 const double& t_expected) {
+        ErrorStats& stats = t_stats["stability " + t_variant];
+        ++stats.num_checks;
+        if (t_value != t_expected) {
+            report(stats, t_variant, t_value, t_expected);
+        }
+    };
+    const auto get_params = [](const Count& t_num_nodes, const double& t_gamma) {
+        Parameters<T> params;
+        params.phase.assign(t_num_nodes, 0.0);
+        params.dphase.assign(t_num_nodes, 0.0);
+        params.power.assign(t_num_nodes, 0.0);
+        params.gamma.assign(t_num_nodes, t_gamma);
+        params.mass.assign(t_num_nodes, 1.0);
+        return params;
+    };
+
+    //* Ring
+    constexpr Count num_nodes = 100;
+    Parameters<T> ring_params = get_params(num_nodes, 0.1);
+    for (Node node = 0; node < num_nodes; ++node) {
+        ring_params.weighted_edge_list.emplace_back(node, (node + 1) % num_nodes, 1.0);
+    }
+    const StabilityReport ring = analyze_backend("", backend, ring_params);
+    const double max_stiffness = 4.0;
+    check("ring min_stiffness",
+          ring.min_stiffness,
+          2.0 * (1.0 - std::cos(2.0 * M_PI / num_nodes)),
+          max_stiffness);
+    check("ring max_stiffness", ring.max_stiffness, max_stiffness, max_stiffness);
+    check("ring min_damping_ratio", ring.min_damping_ratio, 0.025, 0.025);
+    check_exact("ring converged", ring.min_converged && ring.max_converged, 1.0);
+    check_exact("ring unstable_modes", ring.num_unstable, 0.0);
+
+    //* Slowest frequency among tied decays, at every reorder
+    // Frequency f = sqrt(mu - c^2 / 4) amplifies the error of mu by 1 / (2 f)
+    const double ring_frequency = std::sqrt(ring.min_stiffness - 0.05 * 0.05);
+    pcg64 random_engine(0);
+    const Graph graph = ER::generate_by_degree(40, 6.0, random_engine);
+    Parameters<T> random_params = get_params(graph.num_nodes, 0.1);
+    random_params.weighted_edge_list =
+        Parameters<T>(graph, 0, 0.0, random_engine).weighted_edge_list;
+    const StabilityReport random_network =
+        analyze_backend("", backend, random_params);
+    for (const std::string reorder : {"", "rcm", "degree", "gorder"}) {
+        const Backend reorder_backend("csr", reorder, 0);
+        const std::string name = reorder.empty() ? "none" : reorder;
+        check("ring slowest_frequency " + name,
+              analyze_backend("", reorder_backend, ring_params).slowest_frequency,
+              std::sqrt(2.0 * (1.0 - std::cos(2.0 * M_PI / num_nodes)) - 0.05 * 0.05),
+              max_stiffness / (2.0 * ring_frequency));
+        const StabilityReport reordered =
+            analyze_backend("", reorder_backend, random_params);
+        check("random slowest_frequency " + name,
+              reordered.slowest_frequency,
+              random_network.slowest_frequency,
+              reordered.max_stiffness / (2.0 * random_network.slowest_frequency));
+    }
+
+    //* Two-node saddle
+    Parameters<T> saddle_params = get_params(2, 0.2);
+    saddle_params.weighted_edge_list.emplace_back(0, 1, 1.0);
+    saddle_params.power = {-0.5, 0.5};
+    saddle_params.phase[1] = M_PI - std::asin(0.5);
+    const StabilityReport saddle = analyze_backend("", backend, saddle_params);
+    const double stiffness = std::sqrt(3.0);
+    check_exact("saddle unstable_modes", saddle.num_unstable, 1.0);
+    check_exact("saddle stable", saddle.is_stable(), 0.0);
+    check("saddle slowest_decay",
+          saddle.slowest_decay,
+          -0.1 + std::sqrt(0.01 + stiffness),
+          stiffness);
+    return num_failures;
+}
+
+/* Run every trial at precision T, print statistics of each variant. Return number
+of failed checks */
+template <typename T>
+Count run_trials(const DifferentialOptions& t_options, pcg64& t_random_engine) {
+    constexpr int precision = 8 * sizeof(T);
+    const int num_trials = t_options.get_int("trials");
+    std::map<std::string, ErrorStats> stats;
+    Count num_failures = check_stability<T>(stats);
+
+    for (int trial = 0; trial < num_trials; ++trial) {
+        Parameters<double> trial_params =
+            generate_trial(t_options.get_int("nodes"), t_random_engine);
+        trial_params.dts.assign(t_options.get_int("steps"), 0.01);
+        const Parameters<T> params(trial_params);
+        num_failures += check_trial(t_options, trial, params, stats);
+        num_failures += check_solve(t_options, trial, params, stats);
+        num_failures += check_steady(trial, params, stats);
+    }
+
+    //* Statistics of each variant over every trial
+    std::cout << precision << " bit, " << num_trials << " trials\n"
+              << std::left << std::setw(32) << "variant" << std::right
+              << std::setw(8) << "checks" << std::setw(8) << "fails" << std::setw(12)
+              << "median ulp" << std::setw(12) << "p99 ulp" << std::setw(12)
+              << "max ulp" << std::setw(12) << "max rel" << std::setw(12)
+              << "max error" << "\n";
+    for (auto& [variant, variant_stats] : stats) {
+        std::vector<double>& ulps = variant_stats.ulps;
+        std::sort(ulps.begin(), ulps.end());
+        const auto get_rank = [&ulps](const double& t_fraction) {
+            const size_t rank = t_fraction * ulps.size();
+            return ulps.empty() ? 0.0 : ulps[std::min(ulps.size() - 1, rank)];
+        };
+        std::cout << std::left << std::setw(32) << variant << std::right
+                  << std::setw(8) << variant_stats.num_checks << std::setw(8)
+                  << variant_stats.num_failures << std::setw(12) << get_rank(0.5)
+                  << std::setw(12) << get_rank(0.99) << std::setw(12)
+                  << (ulps.empty() ? 0.0 : ulps.back()) << std::scientific
+                  << std::setprecision(2) << std::setw(12)
+                  << variant_stats.max_relative << std::setw(12)
+                  << variant_stats.max_normalized << std::defaultfloat
+                  << std::setprecision(6) << "\n";
+    }
+    return num_failures;
+}
+
+}  // namespace Swing
+
+int main(int argc, char* argv[]) {
+    const Swing::DifferentialOptions options(argc, argv);
+    pcg64 random_engine(options.get_int("seed"));
+
+    Count num_failures = 0;
+    const std::string& precisions = options.values.at("precisions");
+    for (const std::string& precision : Benchmark::split(precisions)) {
+        if (precision == "32") {
+            num_failures += Swing::run_trials<float>(options, random_engine);
+        } else {
+            num_failures += Swing::run_trials<double>(options, random_engine);
+        }
+    }
+
+    if (num_failures) {
+        std::cout << num_failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "Every check passed\n";
+    return 0;
+}
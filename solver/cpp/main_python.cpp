@@ -1,54 +1,44 @@
-#include <iomanip>
+#include <chrono>
 #include <iostream>
-#include <limits>
 #include <string>
 #include <vector>
 
 #include "arguments.hpp"
+#include "autotune.hpp"
+#include "backend.hpp"
 #include "parameters.hpp"
 #include "solver.hpp"
 #include "solver_original.hpp"
 
 namespace Swing {
 
+/* Backend, kernel and arena are logged to stderr only with "verbose" at solver name */
+const bool is_verbose(const std::string& t_solver_name) {
+    return t_solver_name.find("verbose") != std::string::npos;
+}
+
 template <typename T>
-void solve(const std::string& t_solver_name, const Parameters<T>& t_params) {
-    //* Run Runge-Kutta solver
-    std::vector<std::vector<T>> trajectories;
-    if (t_solver_name.find("rk1") != std::string::npos) {
-        trajectories = Swing::solve_rk1(
-            t_params.weighted_edge_list,
-            {t_params.phase, t_params.dphase},
-            {t_params.power, t_params.gamma, t_params.mass},
-            t_params.dts
-        );
-    } else if (t_solver_name.find("rk2") != std::string::npos) {
-        trajectories = Swing::solve_rk2(
-            t_params.weighted_edge_list,
-            {t_params.phase, t_params.dphase},
-            {t_params.power, t_params.gamma, t_params.mass},
-            t_params.dts
-        );
-    } else {
-        trajectories = Swing::solve_rk4(
-            t_params.weighted_edge_list,
-            {t_params.phase, t_params.dphase},
-            {t_params.power, t_params.gamma, t_params.mass},
-            t_params.dts
-        );
-    }
+std::vector<std::vector<T>> solve(
+    const std::string& t_solver_name,
+    const Parameters<T>& t_params
+) {
+    const bool verbose = is_verbose(t_solver_name);
 
-    //* Report result with maximum precision
-    std::cout << std::setprecision(std::numeric_limits<T>::digits10 + 1);
-    for (const auto& trajectory : trajectories) {
-        for (const auto& traj : trajectory) {
-            std::cout << traj << " ";
-        }
-    }
+    //* Select backend: autotuned or given by solver name
+    const Backend backend =
+        t_solver_name.find("auto") != std::string::npos
+            ? autotune(t_params, get_autotune_cache_file(), verbose)
+            : Backend::from_solver_name(t_solver_name, t_params);
+
+    //* Run solver
+    return solve_backend(t_solver_name, backend, t_params, verbose);
 }
 
 template <typename T>
-void solve_original(const std::string& t_solver_name, const Parameters<T>& t_params) {
+std::vector<std::vector<T>> solve_original(
+    const std::string& t_solver_name,
+    const Parameters<T>& t_params
+) {
     //* Run Runge-Kutta solver
     std::vector<std::vector<T>> trajectories;
     if (t_solver_name.find("rk1") != std::string::npos) {
@@ -73,14 +63,83 @@ void solve_original(const std::string& t_solver_name, const Parameters<T>& t_par
             t_params.dts
         );
     }
+    return trajectories;
+}
 
-    //* Report result with maximum precision
-    std::cout << std::setprecision(std::numeric_limits<T>::digits10 + 1);
-    for (const auto& trajectory : trajectories) {
-        for (const auto& traj : trajectory) {
-            std::cout << traj << " ";
+/* Elapsed time of each stage, written to stderr as "Timing: stage seconds" */
+struct StageTimer {
+    using clock = std::chrono::steady_clock;
+    const bool enabled;
+    const clock::time_point start = clock::now();
+    clock::time_point last = start;
+
+    StageTimer(const bool& t_enabled) : enabled(t_enabled) {}
+
+    void lap(const std::string& t_stage) {
+        const clock::time_point now = clock::now();
+        if (enabled) {
+            const std::chrono::duration<double> stage = now - last;
+            std::cerr << "Timing: " << t_stage << " " << stage.count() << "\n";
+        }
+        last = now;
+    }
+    void total() const {
+        if (enabled) {
+            const std::chrono::duration<double> total = clock::now() - start;
+            std::cerr << "Timing: total " << total.count() << "\n";
         }
     }
+};
+
+/* Read argument file, solve and report trajectories
+With "stability" at solver name, report small-signal stability instead
+With "timing" at solver name, time of each stage is written to stderr
+With "verbose" at solver name, backend, kernel and arena are written to stderr */
+template <typename T>
+void run(
+    const std::string& t_solver_name,
+    const Count& t_num_nodes,
+    const Count& t_num_edges,
+    const Count& t_num_steps,
+    const std::string& t_arg_file_name
+) {
+    StageTimer timer(t_solver_name.find("timing") != std::string::npos);
+
+    // Read argument file and store to a single vector
+    const std::vector<T> args = read_arg_file(
+        t_arg_file_name, 5 * t_num_nodes + 3 * t_num_edges + t_num_steps, (T)0.0
+    );
+    timer.lap("read");
+
+    // Arguments to swing parameters
+    const Parameters<T> params(args, t_num_nodes, t_num_edges, t_num_steps);
+    timer.lap("parameters");
+
+    // Stability analysis instead of trajectories
+    if (t_solver_name.find("stability") != std::string::npos) {
+        const Backend backend = Backend::from_solver_name(t_solver_name, params);
+        const StabilityReport report =
+            analyze_backend(t_solver_name, backend, params, is_verbose(t_solver_name));
+        timer.lap("solve");
+        write_stability_report(std::cout, report);
+        std::cout.flush();
+        timer.lap("output");
+        timer.total();
+        return;
+    }
+
+    // Solve swing equation
+    const std::vector<std::vector<T>> trajectories =
+        t_solver_name.find("original") != std::string::npos
+            ? solve_original(t_solver_name, params)
+            : solve(t_solver_name, params);
+    timer.lap("solve");
+
+    // Report result with maximum precision
+    write_trajectories(std::cout, trajectories);
+    std::cout.flush();
+    timer.lap("output");
+    timer.total();
 }
 
 }  // namespace Swing
@@ -95,37 +154,11 @@ int main(int argc, char* argv[]) {
     const std::string arg_file_name = argv[6];
 
     if (precision == 32) {
-        // Read argument file and store to a single vector
-        const std::vector<float> args = Swing::read_arg_file(
-            arg_file_name, 5 * num_nodes + 3 * num_edges + num_steps, (float)0.0
-        );
-
-        // Arguments to swing parameters
-        const Swing::Parameters<float> params(args, num_nodes, num_edges, num_steps);
-
-        // Solve swing equation
-        if (solver_name.find("orginal") != std::string::npos) {
-            Swing::solve_original(solver_name, params);
-        } else {
-            Swing::solve(solver_name, params);
-        }
-
+        Swing::run<float>(solver_name, num_nodes, num_edges, num_steps, arg_file_name);
     } else {
-        // Read argument file and store to a single vector
-        const std::vector<double> args = Swing::read_arg_file(
-            arg_file_name, 5 * num_nodes + 3 * num_edges + num_steps, (double)0.0
-        );
-
-        // Arguments to swing parameters
-        const Swing::Parameters<double> params(args, num_nodes, num_edges, num_steps);
-
-        // Solve swing equation
-        if (solver_name.find("orginal") != std::string::npos) {
-            Swing::solve_original(solver_name, params);
-        } else {
-            Swing::solve(solver_name, params);
-        }
+        Swing::run<double>(solver_name, num_nodes, num_edges, num_steps, arg_file_name);
     }
 
+    SWING_PROFILE_REPORT();
     return 0;
 }
\ No newline at end of file
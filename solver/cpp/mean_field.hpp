@@ -0,0 +1,135 @@
+/*
+Mean-field representation of dense network
+
+Network is written as complete graph with uniform coupling K plus sparse correction
+sum_j K_ij sin(theta_j - theta_i)
+= K * (S cos(theta_i) - C sin(theta_i)) + sum_j (K_ij - K) sin(theta_j - theta_i)
+where S = sum_j sin(theta_j), C = sum_j cos(theta_j).
+The first term costs O(N) and correction edges are
+- missing edge of the network: weight -K
+- edge whose weight is not K: weight K_ij - K
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "profiler.hpp"
+#include "weighted_edge.hpp"
+
+using Count = uint64_t;
+
+namespace Swing {
+
+template <typename T, typename I = uint32_t>
+struct MeanField {
+    Count num_nodes;
+    T coupling;                                    // K
+    std::vector<WeightedEdge<T, I>> corrections;  // (C, ), sorted
+
+    MeanField() {}
+    template <typename J>
+    MeanField(
+        const Count& t_num_nodes,
+        const std::vector<WeightedEdge<T, J>>& t_weighted_edge_list
+    )
+        : num_nodes(t_num_nodes) {
+        SWING_PROFILE_SCOPE("network");
+        coupling = get_coupling(t_weighted_edge_list);
+
+        //* Edges sorted by node1 < node2
+        std::vector<WeightedEdge<T, I>> edges;
+        edges.reserve(t_weighted_edge_list.size());
+        for (const WeightedEdge<T, J>& weighted_edge : t_weighted_edge_list) {
+            edges.emplace_back(
+                std::min(weighted_edge.node1, weighted_edge.node2),
+                std::max(weighted_edge.node1, weighted_edge.node2),
+                weighted_edge.weight
+            );
+        }
+        const auto is_less = [](const WeightedEdge<T, I>& a,
+                                const WeightedEdge<T, I>& b) {
+            return a.node1 < b.node1 || (a.node1 == b.node1 && a.node2 < b.node2);
+        };
+        if (not std::is_sorted(edges.begin(), edges.end(), is_less)) {
+            std::sort(edges.begin(), edges.end(), is_less);
+        }
+
+        //* Scan every pair of nodes against sorted edges
+        corrections.reserve(
+            get_num_corrections(num_nodes, t_weighted_edge_list, coupling)
+        );
+        auto edge = edges.begin();
+        for (Count node1 = 0; node1 < num_nodes; ++node1) {
+            for (Count node2 = node1 + 1; node2 < num_nodes; ++node2) {
+                if (edge != edges.end() && edge->node1 == node1 &&
+                    edge->node2 == node2) {
+                    if (edge->weight != coupling) {
+                        corrections.emplace_back(node1, node2, edge->weight - coupling);
+                    }
+                    ++edge;
+                } else {
+                    corrections.emplace_back(node1, node2, -coupling);
+                }
+            }
+        }
+    }
+
+    /* Most frequent weight of the network */
+    template <typename J>
+    static const T get_coupling(
+        const std::vector<WeightedEdge<T, J>>& t_weighted_edge_list
+    ) {
+        std::map<T, Count> frequency;
+        for (const WeightedEdge<T, J>& weighted_edge : t_weighted_edge_list) {
+            ++frequency[weighted_edge.weight];
+        }
+        if (frequency.empty()) {
+            return 0.0;
+        }
+        return std::max_element(
+                   frequency.begin(),
+                   frequency.end(),
+                   [](const auto& a, const auto& b) { return a.second < b.second; }
+        )->first;
+    }
+
+    /* Number of correction edges: missing edges and edges with weight not K */
+    template <typename J>
+    static const Count get_num_corrections(
+        const Count& t_num_nodes,
+        const std::vector<WeightedEdge<T, J>>& t_weighted_edge_list,
+        const T& t_coupling
+    ) {
+        const Count num_pairs = t_num_nodes * (t_num_nodes - 1) / 2;
+        const Count num_uniform = std::count_if(
+            t_weighted_edge_list.begin(),
+            t_weighted_edge_list.end(),
+            [&t_coupling](const WeightedEdge<T, J>& t_weighted_edge) {
+                return t_weighted_edge.weight == t_coupling;
+            }
+        );
+        return num_pairs - num_uniform;
+    }
+
+    /* Check if the network is dense enough that mean-field with corrections is
+    cheaper than edge list: corrections are less than half of the edges */
+    template <typename J>
+    static const bool is_efficient(
+        const Count& t_num_nodes,
+        const std::vector<WeightedEdge<T, J>>& t_weighted_edge_list
+    ) {
+        // Missing edges alone exceed half of the edges
+        const Count num_pairs = t_num_nodes * (t_num_nodes - 1) / 2;
+        if (t_num_nodes < 2 || 3 * t_weighted_edge_list.size() < 2 * num_pairs) {
+            return false;
+        }
+        const T coupling = get_coupling(t_weighted_edge_list);
+        return 2 * get_num_corrections(t_num_nodes, t_weighted_edge_list, coupling) <
+               t_weighted_edge_list.size();
+    }
+};
+
+}  // namespace Swing
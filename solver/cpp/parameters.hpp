@@ -1,11 +1,15 @@
 #pragma once
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
 #include <random>
 #include <vector>
 
 #include "graph.hpp"
 #include "pcg_random.hpp"
+#include "profiler.hpp"
 #include "weighted_edge.hpp"
 
 using Count = uint64_t;
@@ -13,6 +17,16 @@ using Node = uint64_t;
 
 namespace Swing {
 
+/* Node id of weighted edge list, which stores 32-bit indices */
+inline void check_node_index(const Node& t_node) {
+    using Index = decltype(WeightedEdge<double>::node1);
+    if (t_node > std::numeric_limits<Index>::max()) {
+        std::cout << "Node " << t_node << " is too large for the index type of "
+                  << "weighted edge list\n";
+        exit(1);
+    }
+}
+
 template <typename T>
 struct Parameters {
     //* Parameters: node properties
@@ -59,11 +73,17 @@ struct Parameters {
         mass.assign(t_graph.num_nodes, 1.0);
 
         //* Weighted edge_list with all weights are 1
+        if (t_graph.num_nodes > 0) {
+            check_node_index(t_graph.num_nodes - 1);
+        }
         weighted_edge_list.reserve(t_graph.num_edges);
-        for (const auto edge_list : t_graph.get_edge_list()) {
-            weighted_edge_list.emplace_back(
-                WeightedEdge<T>(edge_list[0], edge_list[1], (T)1.0)
-            );
+        // Scan adjacency list directly: no temporary edge list of vectors
+        for (Node node = 0; node < t_graph.num_nodes; ++node) {
+            for (const Node& neighbor : t_graph.adjacency_list[node]) {
+                if (node < neighbor) {
+                    weighted_edge_list.emplace_back(node, neighbor, (T)1.0);
+                }
+            }
         }
 
         //* Fill dts with value dt
@@ -76,6 +96,7 @@ struct Parameters {
         const Count& t_num_edges,
         const Count& t_num_steps
     ) {
+        SWING_PROFILE_SCOPE("parse");
         //* Parameter locations at argument file
         const Count phase_start_idx = 0;
         const Count dphase_start_idx = phase_start_idx + t_num_nodes;
@@ -104,6 +125,7 @@ struct Parameters {
         for (Count e = 0; e < t_num_edges; ++e) {
             const Node node1 = (Node)t_args[wedge_list_start_idx + 3 * e];
             const Node node2 = (Node)t_args[wedge_list_start_idx + 3 * e + 1];
+            check_node_index(std::max(node1, node2));
             const T weight = t_args[wedge_list_start_idx + 3 * e + 2];
             weighted_edge_list.emplace_back(WeightedEdge<T>(node1, node2, weight));
         }
@@ -114,6 +136,35 @@ struct Parameters {
             dts[t] = t_args[dt_start_idx + t];
         }
     }
+
+    /* Same parameters at another precision */
+    template <typename U>
+    explicit Parameters(const Parameters<U>& t_params)
+        : phase(t_params.phase.begin(), t_params.phase.end()),
+          dphase(t_params.dphase.begin(), t_params.dphase.end()),
+          power(t_params.power.begin(), t_params.power.end()),
+          gamma(t_params.gamma.begin(), t_params.gamma.end()),
+          mass(t_params.mass.begin(), t_params.mass.end()),
+          dts(t_params.dts.begin(), t_params.dts.end()) {
+        weighted_edge_list.reserve(t_params.weighted_edge_list.size());
+        for (const WeightedEdge<U>& weighted_edge : t_params.weighted_edge_list) {
+            weighted_edge_list.emplace_back(
+                weighted_edge.node1, weighted_edge.node2, (T)weighted_edge.weight
+            );
+        }
+    }
+
+    /* Check if each of power, gamma, mass is same for every node */
+    const bool is_uniform_node_params() const {
+        for (const std::vector<T>* property : {&power, &gamma, &mass}) {
+            if (std::adjacent_find(
+                    property->begin(), property->end(), std::not_equal_to<T>()
+                ) != property->end()) {
+                return false;
+            }
+        }
+        return true;
+    }
 };
 
 }  // namespace Swing
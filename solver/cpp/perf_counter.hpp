@@ -0,0 +1,104 @@
+/*
+Hardware performance counter using linux perf_event_open
+When counter is not available (other OS, permission), count is -1
+With inherit, threads created after opening the counter are counted together
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Swing {
+
+struct PerfCounter {
+    int fd = -1;
+
+    PerfCounter() {}
+    PerfCounter(
+        const uint32_t& t_type,
+        const uint64_t& t_config,
+        const bool& t_inherit = false
+    ) {
+        open(t_type, t_config, t_inherit);
+    }
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+    ~PerfCounter() { close(); }
+
+    void open(const uint32_t&, const uint64_t&, const bool& = false);
+    void close();
+    const bool is_available() const { return fd >= 0; }
+
+    void start();
+    void stop();
+    const long long count() const;
+};
+
+/* Open counter of user space events of this thread */
+void PerfCounter::open(
+    const uint32_t& t_type,
+    const uint64_t& t_config,
+    const bool& t_inherit
+) {
+#ifdef __linux__
+    close();
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = t_type;
+    attr.config = t_config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = t_inherit;
+    fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+void PerfCounter::close() {
+#ifdef __linux__
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+    fd = -1;
+}
+
+/* Reset and start counting */
+void PerfCounter::start() {
+#ifdef __linux__
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void PerfCounter::stop() {
+#ifdef __linux__
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+#endif
+}
+
+/* Number of events between start and stop */
+const long long PerfCounter::count() const {
+    long long count = -1;
+#ifdef __linux__
+    if (fd >= 0 && read(fd, &count, sizeof(count)) != sizeof(count)) {
+        count = -1;
+    }
+#endif
+    return count;
+}
+
+}  // namespace Swing
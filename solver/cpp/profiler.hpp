@@ -0,0 +1,246 @@
+/*
+Instrumentation of hot path: per-phase timers and hardware counters
+
+Compiled only with -DSWING_PROFILE. Otherwise every macro expands to nothing and
+the solver is unchanged.
+
+SWING_PROFILE_SCOPE(name): time from here to the end of enclosing block
+SWING_PROFILE_REPORT(): print summary to stderr and write Chrome-trace JSON
+
+Phases
+- sincos: sin, cos of every phase
+- accumulate: sum of neighbor sin, cos (CSR kernel also assembles force here)
+- force: P - gamma * velocity + interactions, divided by mass
+- combine: vector arithmetic of Runge-Kutta stages
+- step: a single Runge-Kutta step
+- read, parse, output: argument file and trajectories
+- order, reorder, network: node order, relabeling and network construction
+
+Environment
+- SWING_PROFILE_COUNTERS=1: read cycles, instructions, LLC misses, branch misses
+  via perf_event_open. Threads created after the first scope are counted as well
+- SWING_PROFILE_TRACE: path of Chrome-trace JSON (default: swing_trace.json).
+  Open at chrome://tracing or https://ui.perfetto.dev
+
+Scopes are meant for the serial part of the code, i.e., outside of OpenMP parallel
+regions. Time of nested scope is included at time of outer scope.
+*/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "perf_counter.hpp"
+
+using Count = uint64_t;
+
+#ifdef SWING_PROFILE
+#define SWING_PROFILE_CONCAT_(a, b) a##b
+#define SWING_PROFILE_CONCAT(a, b) SWING_PROFILE_CONCAT_(a, b)
+#define SWING_PROFILE_SCOPE(name) \
+    const Swing::Profiler::Scope SWING_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define SWING_PROFILE_REPORT() Swing::Profiler::get().report()
+#else
+#define SWING_PROFILE_SCOPE(name)
+#define SWING_PROFILE_REPORT()
+#endif
+
+namespace Swing {
+
+class Profiler {
+   public:
+    static constexpr int num_counters = 4;
+    static constexpr const char* counter_names[num_counters] = {
+        "cycles", "instructions", "llc_misses", "branch_misses"};
+
+    /* A single run of a scope, time in microseconds since start of profiler */
+    struct Event {
+        const char* name;
+        double start;
+        double duration;
+        std::array<long long, num_counters> counters;
+    };
+
+    /* Accumulated runs of a scope */
+    struct Summary {
+        Count calls = 0;
+        double duration = 0.0;
+        std::array<long long, num_counters> counters = {0, 0, 0, 0};
+    };
+
+    class Scope {
+       public:
+        Scope(const char* t_name)
+            : m_name(t_name),
+              m_start(get().get_time()),
+              m_counters(get().read_counters()) {}
+        ~Scope() {
+            Profiler& profiler = get();
+            std::array<long long, num_counters> counters = profiler.read_counters();
+            for (int i = 0; i < num_counters; ++i) {
+                counters[i] = m_counters[i] < 0 ? -1 : counters[i] - m_counters[i];
+            }
+            profiler.add(m_name, m_start, profiler.get_time() - m_start, counters);
+        }
+
+       private:
+        const char* m_name;
+        const double m_start;
+        const std::array<long long, num_counters> m_counters;
+    };
+
+    static Profiler& get() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    const double get_time() const {
+        const std::chrono::duration<double, std::micro> time = clock::now() - m_start;
+        return time.count();
+    }
+
+    /* Current value of each counter, -1 if not available */
+    const std::array<long long, num_counters> read_counters() const {
+        std::array<long long, num_counters> counters = {-1, -1, -1, -1};
+        for (int i = 0; i < num_counters && m_counters[i]; ++i) {
+            counters[i] = m_counters[i]->count();
+        }
+        return counters;
+    }
+
+    void add(
+        const char* t_name,
+        const double& t_start,
+        const double& t_duration,
+        const std::array<long long, num_counters>& t_counters
+    );
+    void write_summary(std::ostream& t_stream) const;
+    void write_trace(std::ostream& t_stream) const;
+    void report() const;
+
+   private:
+    using clock = std::chrono::steady_clock;
+    static constexpr size_t max_events = 1 << 20;  // Timeline is cut beyond this
+
+    const clock::time_point m_start = clock::now();
+    std::array<std::unique_ptr<PerfCounter>, num_counters> m_counters;
+    std::vector<Event> m_events;
+    std::map<std::string, Summary> m_summaries;
+
+    Profiler();
+};
+
+Profiler::Profiler() {
+    const char* use_counters = std::getenv("SWING_PROFILE_COUNTERS");
+    if (not use_counters || std::string(use_counters) == "0") {
+        return;
+    }
+#ifdef __linux__
+    const uint64_t configs[num_counters] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < num_counters; ++i) {
+        m_counters[i] = std::make_unique<PerfCounter>();
+        m_counters[i]->open(PERF_TYPE_HARDWARE, configs[i], true);
+        m_counters[i]->start();
+    }
+#endif
+}
+
+void Profiler::add(
+    const char* t_name,
+    const double& t_start,
+    const double& t_duration,
+    const std::array<long long, num_counters>& t_counters
+) {
+    if (m_events.size() < max_events) {
+        m_events.push_back({t_name, t_start, t_duration, t_counters});
+    }
+    Summary& summary = m_summaries[t_name];
+    ++summary.calls;
+    summary.duration += t_duration;
+    for (int i = 0; i < num_counters; ++i) {
+        summary.counters[i] =
+            t_counters[i] < 0 ? -1 : summary.counters[i] + t_counters[i];
+    }
+}
+
+/* Table of calls, total time, share of run time and counters of each scope */
+void Profiler::write_summary(std::ostream& t_stream) const {
+    const double total = get_time();
+    t_stream << std::left << std::setw(12) << "phase" << std::right << std::setw(10)
+             << "calls" << std::setw(12) << "total ms" << std::setw(8) << "%";
+    for (const char* counter_name : counter_names) {
+        t_stream << std::setw(16) << counter_name;
+    }
+    t_stream << std::setw(8) << "IPC" << "\n";
+
+    for (const auto& [name, summary] : m_summaries) {
+        t_stream << std::left << std::setw(12) << name << std::right << std::setw(10)
+                 << summary.calls << std::fixed << std::setprecision(3)
+                 << std::setw(12) << summary.duration / 1e3 << std::setprecision(1)
+                 << std::setw(8) << 100.0 * summary.duration / total;
+        for (const long long& counter : summary.counters) {
+            t_stream << std::setw(16);
+            if (counter < 0) {
+                t_stream << "-";
+            } else {
+                t_stream << counter;
+            }
+        }
+        t_stream << std::setw(8);
+        if (summary.counters[0] > 0 && summary.counters[1] >= 0) {
+            t_stream << std::setprecision(2)
+                     << (double)summary.counters[1] / summary.counters[0];
+        } else {
+            t_stream << "-";
+        }
+        t_stream << "\n" << std::defaultfloat;
+    }
+    if (m_events.size() == max_events) {
+        t_stream << "Timeline is cut at " << max_events << " events\n";
+    }
+}
+
+/* Complete events of Chrome trace format, counters as arguments */
+void Profiler::write_trace(std::ostream& t_stream) const {
+    t_stream << "{\"traceEvents\": [\n" << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < m_events.size(); ++i) {
+        const Event& event = m_events[i];
+        t_stream << "{\"name\": \"" << event.name
+                 << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, \"ts\": " << event.start
+                 << ", \"dur\": " << event.duration << ", \"args\": {";
+        bool first = true;
+        for (int j = 0; j < num_counters; ++j) {
+            if (event.counters[j] >= 0) {
+                t_stream << (first ? "" : ", ") << "\"" << counter_names[j]
+                         << "\": " << event.counters[j];
+                first = false;
+            }
+        }
+        t_stream << "}}" << (i + 1 < m_events.size() ? ",\n" : "\n");
+    }
+    t_stream << "]}\n" << std::defaultfloat;
+}
+
+/* Summary to stderr, timeline to $SWING_PROFILE_TRACE */
+void Profiler::report() const {
+    write_summary(std::cerr);
+    const char* trace_file_name = std::getenv("SWING_PROFILE_TRACE");
+    std::ofstream trace_file(trace_file_name ? trace_file_name : "swing_trace.json");
+    write_trace(trace_file);
+}
+
+}  // namespace Swing
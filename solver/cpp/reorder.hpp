@@ -0,0 +1,271 @@
+/*
+Reorder nodes of the network for cache locality
+
+Node ids given by the generator are random, so the neighbor gathers in
+get_acceleration hit random cache lines. Relabel the nodes once before solving so
+that neighboring nodes have close ids.
+
+- rcm: reverse Cuthill-McKee, minimizes the bandwidth of the adjacency matrix
+- degree: sort nodes by decreasing degree, hubs are packed together
+- gorder: greedily place the node sharing the most neighbors with the recently
+  placed nodes (sliding window)
+
+Order: (N, ), order[new node] = original node
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parameters.hpp"
+#include "profiler.hpp"
+#include "weighted_edge.hpp"
+
+using Node = uint64_t;
+using Count = uint64_t;
+
+namespace Swing {
+
+/* Return neighbors of each node, sorted by node id */
+template <typename T>
+std::vector<std::vector<Node>> get_neighbors(
+    const Count& t_num_nodes, const std::vector<WeightedEdge<T>>& t_weighted_edge_list
+) {
+    std::vector<std::vector<Node>> neighbors(t_num_nodes);
+    for (const WeightedEdge<T>& weighted_edge : t_weighted_edge_list) {
+        neighbors[weighted_edge.node1].emplace_back(weighted_edge.node2);
+        neighbors[weighted_edge.node2].emplace_back(weighted_edge.node1);
+    }
+    for (auto& neighbor : neighbors) {
+        std::sort(neighbor.begin(), neighbor.end());
+    }
+    return neighbors;
+}
+
+/* Reverse Cuthill-McKee order
+Each connected component is traversed breadth first from its minimum degree node,
+visiting neighbors in increasing order of degree */
+const std::vector<Node> get_rcm_order(const std::vector<std::vector<Node>>& t_neighbors
+) {
+    const Count num_nodes = t_neighbors.size();
+
+    // Candidates of starting node: increasing order of degree
+    std::vector<Node> nodes(num_nodes);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    std::stable_sort(nodes.begin(), nodes.end(), [&t_neighbors](Node a, Node b) {
+        return t_neighbors[a].size() < t_neighbors[b].size();
+    });
+
+    std::vector<Node> order;
+    order.reserve(num_nodes);
+    std::vector<bool> visited(num_nodes, false);
+    std::vector<Node> candidates;
+    for (const Node& start : nodes) {
+        if (visited[start]) {
+            continue;
+        }
+
+        // Breadth first search using order itself as a queue
+        visited[start] = true;
+        order.emplace_back(start);
+        for (Count head = order.size() - 1; head < order.size(); ++head) {
+            candidates.clear();
+            for (const Node& neighbor : t_neighbors[order[head]]) {
+                if (not visited[neighbor]) {
+                    visited[neighbor] = true;
+                    candidates.emplace_back(neighbor);
+                }
+            }
+            std::stable_sort(
+                candidates.begin(),
+                candidates.end(),
+                [&t_neighbors](Node a, Node b) {
+                    return t_neighbors[a].size() < t_neighbors[b].size();
+                }
+            );
+            order.insert(order.end(), candidates.begin(), candidates.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/* Decreasing order of degree. Nodes with same degree keep their order */
+const std::vector<Node> get_degree_order(
+    const std::vector<std::vector<Node>>& t_neighbors
+) {
+    std::vector<Node> order(t_neighbors.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&t_neighbors](Node a, Node b) {
+        return t_neighbors[a].size() > t_neighbors[b].size();
+    });
+    return order;
+}
+
+/* Gorder: greedy locality optimizing order
+Score of a node is the number of edges and common neighbors shared with the last
+t_window placed nodes. Place the node of maximum score one by one.
+Common neighbors through hubs larger than t_max_hub_degree are ignored, since they
+cost O(degree^2) and carry little locality */
+const std::vector<Node> get_gorder(
+    const std::vector<std::vector<Node>>& t_neighbors,
+    const Count& t_window = 5,
+    const Count& t_max_hub_degree = 256
+) {
+    const Count num_nodes = t_neighbors.size();
+
+    std::vector<long long> score(num_nodes, 0);
+    std::vector<bool> placed(num_nodes, false);
+    std::priority_queue<std::pair<long long, Node>> queue;  // lazy max heap
+
+    // Add t_delta to the score of nodes related to t_node
+    auto update = [&](const Node& t_node, const long long& t_delta) {
+        auto add = [&](const Node& t_target) {
+            if (placed[t_target]) {
+                return;
+            }
+            score[t_target] += t_delta;
+            queue.emplace(score[t_target], t_target);
+        };
+        for (const Node& neighbor : t_neighbors[t_node]) {
+            add(neighbor);
+            if (t_neighbors[neighbor].size() > t_max_hub_degree) {
+                continue;
+            }
+            for (const Node& sibling : t_neighbors[neighbor]) {
+                if (sibling != t_node) {
+                    add(sibling);
+                }
+            }
+        }
+    };
+
+    // Seed of each connected component: decreasing order of degree
+    const std::vector<Node> seeds = get_degree_order(t_neighbors);
+    Count seed_idx = 0;
+
+    std::vector<Node> order;
+    order.reserve(num_nodes);
+    while (order.size() < num_nodes) {
+        // Pop node with maximum score, skipping outdated entries
+        Node node = num_nodes;
+        while (not queue.empty()) {
+            const auto [node_score, candidate] = queue.top();
+            queue.pop();
+            if (not placed[candidate] && node_score == score[candidate]) {
+                node = candidate;
+                break;
+            }
+        }
+        // No related node left: start from the next seed
+        if (node == num_nodes) {
+            while (placed[seeds[seed_idx]]) {
+                ++seed_idx;
+            }
+            node = seeds[seed_idx];
+        }
+
+        placed[node] = true;
+        order.emplace_back(node);
+        update(node, 1);
+        if (order.size() > t_window) {
+            update(order[order.size() - 1 - t_window], -1);
+        }
+    }
+    return order;
+}
+
+/* Return node order of given method. Empty order for unknown method */
+template <typename T>
+const std::vector<Node> get_node_order(
+    const std::string& t_method,
+    const Count& t_num_nodes,
+    const std::vector<WeightedEdge<T>>& t_weighted_edge_list
+) {
+    SWING_PROFILE_SCOPE("order");
+    if (t_method == "rcm") {
+        return get_rcm_order(get_neighbors(t_num_nodes, t_weighted_edge_list));
+    } else if (t_method == "degree") {
+        return get_degree_order(get_neighbors(t_num_nodes, t_weighted_edge_list));
+    } else if (t_method == "gorder") {
+        return get_gorder(get_neighbors(t_num_nodes, t_weighted_edge_list));
+    }
+    return {};
+}
+
+/* Find reorder method inside solver name. Empty string if not specified */
+const std::string get_reorder_method(const std::string& t_solver_name) {
+    for (const std::string method : {"rcm", "degree", "gorder"}) {
+        if (t_solver_name.find(method) != std::string::npos) {
+            return method;
+        }
+    }
+    return "";
+}
+
+/* Relabel nodes of parameters by given order
+Edges are relabeled to node1 < node2 and sorted, so that edge list is also scanned
+in the order of nodes */
+template <typename T>
+void reorder(Parameters<T>& t_params, const std::vector<Node>& t_order) {
+    SWING_PROFILE_SCOPE("reorder");
+    const Count num_nodes = t_order.size();
+
+    // New label of each original node
+    std::vector<Node> label(num_nodes);
+    for (Node node = 0; node < num_nodes; ++node) {
+        label[t_order[node]] = node;
+    }
+
+    //* Node properties
+    for (std::vector<T>* property :
+         {&t_params.phase, &t_params.dphase, &t_params.power, &t_params.gamma,
+          &t_params.mass}) {
+        std::vector<T> reordered(num_nodes);
+        for (Node node = 0; node < num_nodes; ++node) {
+            reordered[node] = (*property)[t_order[node]];
+        }
+        *property = std::move(reordered);
+    }
+
+    //* Network properties
+    for (WeightedEdge<T>& weighted_edge : t_params.weighted_edge_list) {
+        const Node node1 = label[weighted_edge.node1];
+        const Node node2 = label[weighted_edge.node2];
+        weighted_edge.node1 = std::min(node1, node2);
+        weighted_edge.node2 = std::max(node1, node2);
+    }
+    std::sort(
+        t_params.weighted_edge_list.begin(),
+        t_params.weighted_edge_list.end(),
+        [](const WeightedEdge<T>& a, const WeightedEdge<T>& b) {
+            return a.node1 < b.node1 || (a.node1 == b.node1 && a.node2 < b.node2);
+        }
+    );
+}
+
+/* Map trajectories of reordered nodes back to the original node ids
+t_trajectories: (S+1, 2 * N), phase1, ... phaseN, dphase1,...,dphaseN */
+template <typename T>
+void restore_order(
+    std::vector<std::vector<T>>& t_trajectories, const std::vector<Node>& t_order
+) {
+    SWING_PROFILE_SCOPE("reorder");
+    const Count num_nodes = t_order.size();
+    std::vector<T> restored(2 * num_nodes);
+    for (std::vector<T>& trajectory : t_trajectories) {
+        for (Node node = 0; node < num_nodes; ++node) {
+            restored[t_order[node]] = trajectory[node];
+            restored[num_nodes + t_order[node]] = trajectory[num_nodes + node];
+        }
+        std::swap(trajectory, restored);
+    }
+}
+
+}  // namespace Swing
@@ -0,0 +1,167 @@
+/*
+Roofline model of get_acceleration
+
+Machine ceilings are measured, not taken from data sheets
+- bandwidth: STREAM triad a = b + s * c with OpenMP, 3 * 8 bytes per element
+  (write allocate is not counted, as STREAM does)
+- peak: independent multiply-add chains with OpenMP, compiled with the same flags
+  as the solver, so that it is the peak reachable by this build
+
+Cost of kernel is the compulsory memory traffic and floating point operations of a
+single get_acceleration: network structure is streamed once, each node vector is
+read or written once per pass, and gathered sin, cos are assumed to hit cache.
+sin, cos are not counted as flops.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "csr.hpp"
+#include "dense.hpp"
+#include "mean_field.hpp"
+#include "weighted_edge.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using Count = uint64_t;
+
+namespace Swing {
+
+/* Bytes and flops of a single get_acceleration */
+struct KernelCost {
+    double bytes = 0.0;
+    double flops = 0.0;
+
+    const double get_intensity() const { return bytes > 0.0 ? flops / bytes : 0.0; }
+};
+
+/* Bytes per second of STREAM triad over arrays of t_num_values doubles */
+const double get_stream_bandwidth(const Count& t_num_values, const int& t_repeats = 5) {
+    using clock = std::chrono::steady_clock;
+    std::vector<double> a(t_num_values), b(t_num_values), c(t_num_values);
+    const long long num_values = t_num_values;
+
+    // First touch by the thread that streams the values later
+#pragma omp parallel for schedule(static)
+    for (long long i = 0; i < num_values; ++i) {
+        a[i] = 0.0;
+        b[i] = 1.0;
+        c[i] = 2.0;
+    }
+
+    double best = 0.0;
+    for (int repeat = 0; repeat <= t_repeats; ++repeat) {
+        const auto start = clock::now();
+#pragma omp parallel for schedule(static)
+        for (long long i = 0; i < num_values; ++i) {
+            a[i] = b[i] + 3.0 * c[i];
+        }
+        const std::chrono::duration<double> sec = clock::now() - start;
+        if (repeat > 0) {  // First run is warmup
+            best = std::max(best, 3.0 * sizeof(double) * num_values / sec.count());
+        }
+    }
+    volatile double sink = a[num_values / 2];
+    (void)sink;
+    return best;
+}
+
+/* Floating point operations per second of independent multiply-add chains */
+template <typename T>
+const double get_peak_flops(const int& t_repeats = 5) {
+    using clock = std::chrono::steady_clock;
+    constexpr int width = 64;  // Independent chains hiding latency of each add
+    constexpr Count num_iterations = 1 << 16;
+
+    double best = 0.0;
+    for (int repeat = 0; repeat <= t_repeats; ++repeat) {
+        int num_threads = 1;
+        const auto start = clock::now();
+#pragma omp parallel
+        {
+#ifdef _OPENMP
+#pragma omp single
+            num_threads = omp_get_num_threads();
+#endif
+            T chains[width];
+            for (int k = 0; k < width; ++k) {
+                chains[k] = (T)k;
+            }
+            const T mul = (T)0.999999, add = (T)1e-6;
+            for (Count iteration = 0; iteration < num_iterations; ++iteration) {
+#pragma omp simd
+                for (int k = 0; k < width; ++k) {
+                    chains[k] = chains[k] * mul + add;
+                }
+            }
+            volatile T sink = chains[0] + chains[width - 1];
+            (void)sink;
+        }
+        const std::chrono::duration<double> sec = clock::now() - start;
+        if (repeat > 0) {
+            best = std::max(
+                best, 2.0 * width * num_iterations * num_threads / sec.count()
+            );
+        }
+    }
+    return best;
+}
+
+//* Bytes and flops of each network representation
+// Per node: P - gamma * velocity, 2 multiply-adds of interactions, division by mass
+constexpr double node_flops = 7.0;
+
+template <typename T, typename I>
+const KernelCost get_kernel_cost(
+    const std::vector<WeightedEdge<T, I>>& t_weighted_edge_list,
+    const Count& t_num_nodes
+) {
+    // phase, sin, cos, gathered sin, cos, zeroed and read adjacent sums,
+    // dphase, power, gamma, mass, force
+    const double num_edges = t_weighted_edge_list.size();
+    return {
+        num_edges * sizeof(WeightedEdge<T, I>) + 16.0 * t_num_nodes * sizeof(T),
+        8.0 * num_edges + node_flops * t_num_nodes};
+}
+
+template <typename T, typename I>
+const KernelCost get_kernel_cost(const CSR<T, I>& t_csr, const Count& t_num_nodes) {
+    // Adjacent sums stay at registers. Uniform node parameters are read once
+    const double num_entries = t_csr.neighbors.size();
+    const double node_values = t_csr.uniform_node_params ? 9.0 : 12.0;
+    return {
+        (t_num_nodes + 1.0) * sizeof(I) + num_entries * sizeof(I) +
+            t_csr.weights.size() * sizeof(T) + node_values * t_num_nodes * sizeof(T),
+        (t_csr.is_unit_weight() ? 2.0 : 4.0) * num_entries +
+            node_flops * t_num_nodes};
+}
+
+template <typename T, typename I>
+const KernelCost get_kernel_cost(
+    const MeanField<T, I>& t_mean_field,
+    const Count& t_num_nodes
+) {
+    const double num_corrections = t_mean_field.corrections.size();
+    return {
+        num_corrections * sizeof(WeightedEdge<T, I>) +
+            16.0 * t_num_nodes * sizeof(T),
+        8.0 * num_corrections + (node_flops + 2.0) * t_num_nodes};
+}
+
+template <typename T>
+const KernelCost get_kernel_cost(
+    const DenseMatrix<T>& t_dense,
+    const Count& t_num_nodes
+) {
+    const double num_entries = (double)t_num_nodes * t_dense.stride;
+    return {
+        num_entries * sizeof(T) + 14.0 * t_num_nodes * sizeof(T),
+        4.0 * num_entries + node_flops * t_num_nodes};
+}
+
+}  // namespace Swing
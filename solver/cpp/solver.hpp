@@ -12,10 +12,23 @@ sum_j K_ij * A_ij * sin(theta_j-theta_i)
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <string>
 #include <vector>
 
+#include "arena.hpp"
+#include "csr.hpp"
+#include "dense.hpp"
+#include "krylov.hpp"
 #include "linear_algebra.hpp"
+#include "mean_field.hpp"
+#include "profiler.hpp"
 #include "weighted_edge.hpp"
 
 using Node = uint64_t;
@@ -25,9 +38,9 @@ using mat = std::vector<std::vector<T>>;
 
 namespace Swing {
 
-template <typename T>
+template <typename T, typename I>
 std::vector<T> get_acceleration(
-    const std::vector<WeightedEdge<T>>& t_weighted_edge_list,
+    const std::vector<WeightedEdge<T, I>>& t_weighted_edge_list,
     const std::vector<std::vector<T>>& t_state,
     const std::vector<std::vector<T>>& t_params
 ) {
@@ -41,27 +54,37 @@ std::vector<T> get_acceleration(
 
     const Count num_nodes = t_state[0].size();
 
-    std::vector<T> sin_phase(num_nodes);
-    std::vector<T> cos_phase(num_nodes);
-    for (Node node = 0; node < num_nodes; ++node) {
-        sin_phase[node] = std::sin(t_state[0][node]);
-        cos_phase[node] = std::cos(t_state[0][node]);
+    // Scratch of this call, given back to the arena at return
+    Arena& arena = get_thread_arena();
+    const Arena::Scope scope(arena);
+    std::pmr::vector<T> sin_phase(num_nodes, &arena);
+    std::pmr::vector<T> cos_phase(num_nodes, &arena);
+    {
+        SWING_PROFILE_SCOPE("sincos");
+        for (Node node = 0; node < num_nodes; ++node) {
+            sin_phase[node] = std::sin(t_state[0][node]);
+            cos_phase[node] = std::cos(t_state[0][node]);
+        }
     }
 
-    std::vector<T> sin_phase_adj(num_nodes, 0.0);
-    std::vector<T> cos_phase_adj(num_nodes, 0.0);
-    for (const WeightedEdge<T> weighted_edge : t_weighted_edge_list) {
-        const Node node1 = weighted_edge.node1;
-        const Node node2 = weighted_edge.node2;
-        const T weight = weighted_edge.weight;
+    std::pmr::vector<T> sin_phase_adj(num_nodes, 0.0, &arena);
+    std::pmr::vector<T> cos_phase_adj(num_nodes, 0.0, &arena);
+    {
+        SWING_PROFILE_SCOPE("accumulate");
+        for (const WeightedEdge<T, I>& weighted_edge : t_weighted_edge_list) {
+            const Node node1 = weighted_edge.node1;
+            const Node node2 = weighted_edge.node2;
+            const T weight = weighted_edge.weight;
 
-        sin_phase_adj[node1] += weight * sin_phase[node2];
-        sin_phase_adj[node2] += weight * sin_phase[node1];
-        cos_phase_adj[node1] += weight * cos_phase[node2];
-        cos_phase_adj[node2] += weight * cos_phase[node1];
+            sin_phase_adj[node1] += weight * sin_phase[node2];
+            sin_phase_adj[node2] += weight * sin_phase[node1];
+            cos_phase_adj[node1] += weight * cos_phase[node2];
+            cos_phase_adj[node2] += weight * cos_phase[node1];
+        }
     }
 
     std::vector<T> force(num_nodes);
+    SWING_PROFILE_SCOPE("force");
     for (Node node = 0; node < num_nodes; ++node) {
         // P - gamma * velocity
         force[node] = t_params[0][node] - t_params[1][node] * t_state[1][node];
@@ -77,9 +100,340 @@ std::vector<T> get_acceleration(
     return force;
 }
 
+template <bool UnitWeight, bool UniformParams, typename Sum, typename T, typename I>
+std::vector<T> get_acceleration_csr(
+    const CSR<T, I>& t_csr,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params
+) {
+    /*
+    t_csr: (N+1, ) offsets and (2E, ) neighbors, weights of each node
+    t_state: (2, N), phase, dphase of each node
+    t_params: (3, N), node features of power, gamma, mass
+
+    UnitWeight: weights are not loaded
+    UniformParams: power, gamma, mass of node 0 are kept as constants
+    Sum: type of per-node sums of neighbors and force, double at mixed precision
+    */
+
+    const Count num_nodes = t_state[0].size();
+    if (num_nodes == 0) {
+        // Empty network: node 0 does not exist to read uniform parameters
+        return {};
+    }
+
+    // Scratch of this call, given back to the arena at return
+    Arena& arena = get_thread_arena();
+    const Arena::Scope scope(arena);
+    std::pmr::vector<T> sin_phase(num_nodes, &arena);
+    std::pmr::vector<T> cos_phase(num_nodes, &arena);
+    {
+        SWING_PROFILE_SCOPE("sincos");
+#pragma omp parallel for schedule(static)
+        for (Node node = 0; node < num_nodes; ++node) {
+            sin_phase[node] = std::sin(t_state[0][node]);
+            cos_phase[node] = std::cos(t_state[0][node]);
+        }
+    }
+
+    const T power = t_params[0][0];
+    const T gamma = t_params[1][0];
+    const T mass = t_params[2][0];
+    const I* offsets = t_csr.offsets.data();
+    const I* neighbors = t_csr.neighbors.data();
+    const T* weights = t_csr.weights.data();
+
+    // Each node is independent: distributed to threads in chunks
+    std::vector<T> force(num_nodes);
+    SWING_PROFILE_SCOPE("accumulate");
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (Node node = 0; node < num_nodes; ++node) {
+        // Gather neighbors of the node
+        Sum sin_phase_adj = 0.0;
+        Sum cos_phase_adj = 0.0;
+        for (I idx = offsets[node]; idx < offsets[node + 1]; ++idx) {
+            if constexpr (UnitWeight) {
+                sin_phase_adj += sin_phase[neighbors[idx]];
+                cos_phase_adj += cos_phase[neighbors[idx]];
+            } else {
+                sin_phase_adj += weights[idx] * sin_phase[neighbors[idx]];
+                cos_phase_adj += weights[idx] * cos_phase[neighbors[idx]];
+            }
+        }
+
+        // P - gamma * velocity
+        Sum node_force;
+        if constexpr (UniformParams) {
+            node_force = power - gamma * t_state[1][node];
+        } else {
+            node_force = t_params[0][node] - t_params[1][node] * t_state[1][node];
+        }
+
+        // Interactions
+        node_force += cos_phase[node] * sin_phase_adj;
+        node_force -= sin_phase[node] * cos_phase_adj;
+
+        // a = F / m
+        if constexpr (UniformParams) {
+            force[node] = node_force / mass;
+        } else {
+            force[node] = node_force / t_params[2][node];
+        }
+    }
+
+    return force;
+}
+
+/* Dispatch to the kernel specialized for unit weight and uniform node parameters */
+template <typename Sum, typename T, typename I>
+std::vector<T> get_acceleration_csr(
+    const CSR<T, I>& t_csr,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params
+) {
+    if (t_csr.is_unit_weight()) {
+        return t_csr.uniform_node_params
+                   ? get_acceleration_csr<true, true, Sum>(t_csr, t_state, t_params)
+                   : get_acceleration_csr<true, false, Sum>(t_csr, t_state, t_params);
+    }
+    return t_csr.uniform_node_params
+               ? get_acceleration_csr<false, true, Sum>(t_csr, t_state, t_params)
+               : get_acceleration_csr<false, false, Sum>(t_csr, t_state, t_params);
+}
+
+template <typename T, typename I>
+std::vector<T> get_acceleration(
+    const CSR<T, I>& t_csr,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params
+) {
+    return t_csr.double_sums
+               ? get_acceleration_csr<double>(t_csr, t_state, t_params)
+               : get_acceleration_csr<T>(t_csr, t_state, t_params);
+}
+
+/*
+Acceleration of t_nodes alone, t_acceleration[k] of node t_nodes[k]
+t_sin_phase, t_cos_phase: (N, ), valid at every neighbor of t_nodes and at t_nodes
+t_dphase: (N, ), read at t_nodes
+*/
+template <typename T, typename I>
+void get_acceleration_subset(
+    const CSR<T, I>& t_csr,
+    const std::vector<Node>& t_nodes,
+    const std::vector<T>& t_sin_phase,
+    const std::vector<T>& t_cos_phase,
+    const std::vector<T>& t_dphase,
+    const std::vector<std::vector<T>>& t_params,
+    std::vector<T>& t_acceleration
+) {
+    SWING_PROFILE_SCOPE("accumulate");
+    const I* offsets = t_csr.offsets.data();
+    const I* neighbors = t_csr.neighbors.data();
+    const T* weights = t_csr.weights.data();
+    const bool unit_weight = t_csr.is_unit_weight();
+    const Count num_nodes = t_nodes.size();
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (Count k = 0; k < num_nodes; ++k) {
+        const Node node = t_nodes[k];
+        T sin_phase_adj = 0.0;
+        T cos_phase_adj = 0.0;
+        for (I idx = offsets[node]; idx < offsets[node + 1]; ++idx) {
+            const T weight = unit_weight ? (T)1.0 : weights[idx];
+            sin_phase_adj += weight * t_sin_phase[neighbors[idx]];
+            cos_phase_adj += weight * t_cos_phase[neighbors[idx]];
+        }
+        T node_force = t_params[0][node] - t_params[1][node] * t_dphase[node];
+        node_force += t_cos_phase[node] * sin_phase_adj;
+        node_force -= t_sin_phase[node] * cos_phase_adj;
+        t_acceleration[k] = node_force / t_params[2][node];
+    }
+}
+
+template <typename T, typename I>
+std::vector<T> get_acceleration(
+    const MeanField<T, I>& t_mean_field,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params
+) {
+    /*
+    t_mean_field: uniform coupling K of complete graph and (C, ) correction edges
+    t_state: (2, N), phase, dphase of each node
+    t_params: (3, N), node features of power, gamma, mass
+    */
+
+    const Count num_nodes = t_state[0].size();
+
+    // Scratch of this call, given back to the arena at return
+    Arena& arena = get_thread_arena();
+    const Arena::Scope scope(arena);
+    std::pmr::vector<T> sin_phase(num_nodes, &arena);
+    std::pmr::vector<T> cos_phase(num_nodes, &arena);
+
+    // Sum over every node is accumulated at double precision
+    double sin_sum = 0.0;
+    double cos_sum = 0.0;
+    {
+        SWING_PROFILE_SCOPE("sincos");
+        for (Node node = 0; node < num_nodes; ++node) {
+            sin_phase[node] = std::sin(t_state[0][node]);
+            cos_phase[node] = std::cos(t_state[0][node]);
+            sin_sum += sin_phase[node];
+            cos_sum += cos_phase[node];
+        }
+    }
+
+    // Complete graph: K * S, K * C for every node
+    std::pmr::vector<T> sin_phase_adj(
+        num_nodes, t_mean_field.coupling * sin_sum, &arena
+    );
+    std::pmr::vector<T> cos_phase_adj(
+        num_nodes, t_mean_field.coupling * cos_sum, &arena
+    );
+
+    // Sparse correction
+    {
+        SWING_PROFILE_SCOPE("accumulate");
+        for (const WeightedEdge<T, I>& correction : t_mean_field.corrections) {
+            const Node node1 = correction.node1;
+            const Node node2 = correction.node2;
+            const T weight = correction.weight;
+
+            sin_phase_adj[node1] += weight * sin_phase[node2];
+            sin_phase_adj[node2] += weight * sin_phase[node1];
+            cos_phase_adj[node1] += weight * cos_phase[node2];
+            cos_phase_adj[node2] += weight * cos_phase[node1];
+        }
+    }
+
+    std::vector<T> force(num_nodes);
+    SWING_PROFILE_SCOPE("force");
+    for (Node node = 0; node < num_nodes; ++node) {
+        // P - gamma * velocity
+        force[node] = t_params[0][node] - t_params[1][node] * t_state[1][node];
+
+        // Interactions. Self interaction of complete graph cancels out
+        force[node] += cos_phase[node] * sin_phase_adj[node];
+        force[node] -= sin_phase[node] * cos_phase_adj[node];
+
+        // a = F / m
+        force[node] /= t_params[2][node];
+    }
+
+    return force;
+}
+
 template <typename T>
-std::vector<std::vector<T>> step_rk1(
-    const std::vector<WeightedEdge<T>>& t_weighted_edge_list,
+std::vector<T> get_acceleration(
+    const DenseMatrix<T>& t_dense,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params
+) {
+    /*
+    t_dense: (N, stride), weighted adjacency matrix
+    t_state: (2, N), phase, dphase of each node
+    t_params: (3, N), node features of power, gamma, mass
+
+    [K sin(theta), K cos(theta)] is computed as a single product of K with two
+    columns. Blocks of 4 rows share each load of sin, cos, and blocks are
+    distributed to threads
+    */
+
+    const Count num_nodes = t_state[0].size();
+    const Count stride = t_dense.stride;
+
+    // Scratch of this call, given back to the arena at return
+    Arena& arena = get_thread_arena();
+    const Arena::Scope scope(arena);
+
+    // Zero padded up to the stride
+    std::pmr::vector<T> sin_phase(stride, 0.0, &arena);
+    std::pmr::vector<T> cos_phase(stride, 0.0, &arena);
+    {
+        SWING_PROFILE_SCOPE("sincos");
+#pragma omp parallel for schedule(static)
+        for (Node node = 0; node < num_nodes; ++node) {
+            sin_phase[node] = std::sin(t_state[0][node]);
+            cos_phase[node] = std::cos(t_state[0][node]);
+        }
+    }
+    const T* sin_ptr = sin_phase.data();
+    const T* cos_ptr = cos_phase.data();
+
+    std::pmr::vector<T> sin_phase_adj(num_nodes, &arena);
+    std::pmr::vector<T> cos_phase_adj(num_nodes, &arena);
+    const long long num_blocks = (num_nodes + 3) / 4;
+
+    {
+        SWING_PROFILE_SCOPE("accumulate");
+#pragma omp parallel for schedule(static)
+        for (long long block = 0; block < num_blocks; ++block) {
+            const Node row = 4 * block;
+            if (row + 4 <= num_nodes) {
+                const T* weight0 = t_dense.get_row(row);
+                const T* weight1 = t_dense.get_row(row + 1);
+                const T* weight2 = t_dense.get_row(row + 2);
+                const T* weight3 = t_dense.get_row(row + 3);
+                T sin0 = 0.0, sin1 = 0.0, sin2 = 0.0, sin3 = 0.0;
+                T cos0 = 0.0, cos1 = 0.0, cos2 = 0.0, cos3 = 0.0;
+#pragma omp simd reduction(+ : sin0, sin1, sin2, sin3, cos0, cos1, cos2, cos3)
+                for (Count col = 0; col < stride; ++col) {
+                    sin0 += weight0[col] * sin_ptr[col];
+                    sin1 += weight1[col] * sin_ptr[col];
+                    sin2 += weight2[col] * sin_ptr[col];
+                    sin3 += weight3[col] * sin_ptr[col];
+                    cos0 += weight0[col] * cos_ptr[col];
+                    cos1 += weight1[col] * cos_ptr[col];
+                    cos2 += weight2[col] * cos_ptr[col];
+                    cos3 += weight3[col] * cos_ptr[col];
+                }
+                sin_phase_adj[row] = sin0;
+                sin_phase_adj[row + 1] = sin1;
+                sin_phase_adj[row + 2] = sin2;
+                sin_phase_adj[row + 3] = sin3;
+                cos_phase_adj[row] = cos0;
+                cos_phase_adj[row + 1] = cos1;
+                cos_phase_adj[row + 2] = cos2;
+                cos_phase_adj[row + 3] = cos3;
+            } else {
+                // Remaining rows of the last block
+                for (Node node = row; node < num_nodes; ++node) {
+                    const T* weight = t_dense.get_row(node);
+                    T sin_sum = 0.0, cos_sum = 0.0;
+#pragma omp simd reduction(+ : sin_sum, cos_sum)
+                    for (Count col = 0; col < stride; ++col) {
+                        sin_sum += weight[col] * sin_ptr[col];
+                        cos_sum += weight[col] * cos_ptr[col];
+                    }
+                    sin_phase_adj[node] = sin_sum;
+                    cos_phase_adj[node] = cos_sum;
+                }
+            }
+        }
+    }
+
+    std::vector<T> force(num_nodes);
+    SWING_PROFILE_SCOPE("force");
+    for (Node node = 0; node < num_nodes; ++node) {
+        // P - gamma * velocity
+        force[node] = t_params[0][node] - t_params[1][node] * t_state[1][node];
+
+        // Interactions
+        force[node] += cos_phase[node] * sin_phase_adj[node];
+        force[node] -= sin_phase[node] * cos_phase_adj[node];
+
+        // a = F / m
+        force[node] /= t_params[2][node];
+    }
+
+    return force;
+}
+
+/* Increment of phase, dphase over a single step: dt * (velocity, acceleration) */
+template <typename T, typename Network>
+std::vector<std::vector<T>> get_increment_rk1(
+    const Network& t_network,
     const std::vector<std::vector<T>>& t_state,
     const std::vector<std::vector<T>>& t_params,
     const T& dt
@@ -88,100 +442,165 @@ std::vector<std::vector<T>> step_rk1(
 
     const std::vector<T> velocity = t_state[1];
     const std::vector<T> acceleration =
-        get_acceleration(t_weighted_edge_list, t_state, t_params);
+        get_acceleration(t_network, t_state, t_params);
 
     // Result
-    return {t_state[0] + dt * velocity, t_state[1] + dt * acceleration};
+    SWING_PROFILE_SCOPE("combine");
+    return {dt * velocity, dt * acceleration};
 }
 
-template <typename T>
-std::vector<std::vector<T>> step_rk2(
-    const std::vector<WeightedEdge<T>>& t_weighted_edge_list,
+template <typename T, typename Network>
+std::vector<std::vector<T>> get_increment_rk2(
+    const Network& t_network,
     const std::vector<std::vector<T>>& t_state,
     const std::vector<std::vector<T>>& t_params,
     const T& dt
 ) {
     using namespace LinearAlgebra;
 
-    const Count num_nodes = t_weighted_edge_list.size();
+    const Count num_nodes = t_state[0].size();
     std::vector<std::vector<T>> temp_state = {
         std::vector<T>(num_nodes, 0.0), std::vector<T>(num_nodes, 0.0)};
 
     // Stage 1
     const std::vector<T> velocity1 = t_state[1];
     const std::vector<T> acceleration1 =
-        get_acceleration(t_weighted_edge_list, t_state, t_params);
+        get_acceleration(t_network, t_state, t_params);
 
     // Stage 2
-    temp_state[0] = t_state[0] + dt * velocity1;
-    temp_state[1] = t_state[1] + dt * acceleration1;
+    {
+        SWING_PROFILE_SCOPE("combine");
+        temp_state[0] = t_state[0] + dt * velocity1;
+        temp_state[1] = t_state[1] + dt * acceleration1;
+    }
     const std::vector<T> velocity2 = temp_state[1];
     const std::vector<T> acceleration2 =
-        get_acceleration(t_weighted_edge_list, temp_state, t_params);
+        get_acceleration(t_network, temp_state, t_params);
 
     // Result
+    SWING_PROFILE_SCOPE("combine");
     const std::vector<T> velocity = 0.5 * (velocity1 + velocity2);
     const std::vector<T> acceleration = 0.5 * (acceleration1 + acceleration2);
-    return {t_state[0] + dt * velocity, t_state[1] + dt * acceleration};
+    return {dt * velocity, dt * acceleration};
 }
 
-template <typename T>
-std::vector<std::vector<T>> step_rk4(
-    const std::vector<WeightedEdge<T>>& t_weighted_edge_list,
+template <typename T, typename Network>
+std::vector<std::vector<T>> get_increment_rk4(
+    const Network& t_network,
     const std::vector<std::vector<T>>& t_state,
     const std::vector<std::vector<T>>& t_params,
     const T& dt
 ) {
-    using namespace LinearAlgebra;
+    /*
+    Stage velocities and accelerations are accumulated into weighted sums at the
+    arena, given back at return. Temporary state and accelerations stay at the
+    global allocator since every get_acceleration takes and returns std::vector
+    */
+    const Count num_nodes = t_state[0].size();
 
-    const Count num_nodes = t_weighted_edge_list.size();
-    std::vector<std::vector<T>> temp_state = {
-        std::vector<T>(num_nodes, 0.0), std::vector<T>(num_nodes, 0.0)};
+    // Scratch of this step
+    Arena& arena = get_thread_arena();
+    const Arena::Scope scope(arena);
+    std::pmr::vector<T> velocity_sum(t_state[1].begin(), t_state[1].end(), &arena);
+    std::pmr::vector<T> acceleration_sum(num_nodes, &arena);
 
     // Stage 1
-    const std::vector<T> velocity1 = t_state[1];
-    const std::vector<T> acceleration1 =
-        get_acceleration(t_weighted_edge_list, t_state, t_params);
+    std::vector<std::vector<T>> temp_state = t_state;
+    std::vector<T> acceleration = get_acceleration(t_network, t_state, t_params);
+    std::copy(acceleration.begin(), acceleration.end(), acceleration_sum.begin());
 
-    // Stage 2
-    temp_state[0] = t_state[0] + 0.5 * dt * velocity1;
-    temp_state[1] = t_state[1] + 0.5 * dt * acceleration1;
-    const std::vector<T> velocity2 = temp_state[1];
-    const std::vector<T> acceleration2 =
-        get_acceleration(t_weighted_edge_list, temp_state, t_params);
-
-    // Stage 3
-    temp_state[0] = t_state[0] + 0.5 * dt * velocity2;
-    temp_state[1] = t_state[1] + 0.5 * dt * acceleration2;
-    const std::vector<T> velocity3 = temp_state[1];
-    const std::vector<T> acceleration3 =
-        get_acceleration(t_weighted_edge_list, temp_state, t_params);
-
-    // Stage 4
-    temp_state[0] = t_state[0] + dt * velocity3;
-    temp_state[1] = t_state[1] + dt * acceleration3;
-    const std::vector<T> velocity4 = temp_state[1];
-    const std::vector<T> acceleration4 =
-        get_acceleration(t_weighted_edge_list, temp_state, t_params);
+    // Stage 2, 3, 4 from the velocity and acceleration of the previous stage
+    const T offsets[3] = {(T)0.5 * dt, (T)0.5 * dt, dt};
+    const double weights[3] = {2.0, 2.0, 1.0};
+    for (int stage = 0; stage < 3; ++stage) {
+        {
+            SWING_PROFILE_SCOPE("combine");
+            const T offset = offsets[stage];
+#pragma omp simd
+            for (Node node = 0; node < num_nodes; ++node) {
+                temp_state[0][node] = t_state[0][node] + offset * temp_state[1][node];
+                temp_state[1][node] = t_state[1][node] + offset * acceleration[node];
+                velocity_sum[node] += (T)(weights[stage] * temp_state[1][node]);
+            }
+        }
+        acceleration = get_acceleration(t_network, temp_state, t_params);
+        SWING_PROFILE_SCOPE("combine");
+#pragma omp simd
+        for (Node node = 0; node < num_nodes; ++node) {
+            acceleration_sum[node] += (T)(weights[stage] * acceleration[node]);
+        }
+    }
 
     // Result
-    const std::vector<T> velocity =
-        (velocity1 + 2.0 * velocity2 + 2.0 * velocity3 + velocity4) / 6.0;
-    const std::vector<T> acceleration =
-        (acceleration1 + 2.0 * acceleration2 + 2.0 * acceleration3 + acceleration4) /
-        6.0;
-    return {t_state[0] + dt * velocity, t_state[1] + dt * acceleration};
+    SWING_PROFILE_SCOPE("combine");
+    std::vector<std::vector<T>> increment = {
+        std::vector<T>(num_nodes), std::vector<T>(num_nodes)};
+#pragma omp simd
+    for (Node node = 0; node < num_nodes; ++node) {
+        increment[0][node] = dt * (T)(velocity_sum[node] / 6.0);
+        increment[1][node] = dt * (T)(acceleration_sum[node] / 6.0);
+    }
+    return increment;
 }
 
-template <typename T>
+/* Single step: state + increment */
+template <typename T, typename Network>
+std::vector<std::vector<T>> step_rk1(
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params,
+    const T& dt
+) {
+    SWING_PROFILE_SCOPE("step");
+    using namespace LinearAlgebra;
+
+    const std::vector<std::vector<T>> increment =
+        get_increment_rk1(t_network, t_state, t_params, dt);
+    SWING_PROFILE_SCOPE("combine");
+    return {t_state[0] + increment[0], t_state[1] + increment[1]};
+}
+
+template <typename T, typename Network>
+std::vector<std::vector<T>> step_rk2(
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params,
+    const T& dt
+) {
+    SWING_PROFILE_SCOPE("step");
+    using namespace LinearAlgebra;
+
+    const std::vector<std::vector<T>> increment =
+        get_increment_rk2(t_network, t_state, t_params, dt);
+    SWING_PROFILE_SCOPE("combine");
+    return {t_state[0] + increment[0], t_state[1] + increment[1]};
+}
+
+template <typename T, typename Network>
+std::vector<std::vector<T>> step_rk4(
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params,
+    const T& dt
+) {
+    SWING_PROFILE_SCOPE("step");
+    using namespace LinearAlgebra;
+
+    const std::vector<std::vector<T>> increment =
+        get_increment_rk4(t_network, t_state, t_params, dt);
+    SWING_PROFILE_SCOPE("combine");
+    return {t_state[0] + increment[0], t_state[1] + increment[1]};
+}
+
+template <typename T, typename Network>
 std::vector<std::vector<T>> solve_rk1(
-    const std::vector<WeightedEdge<T>>& t_weighted_edge_list,
+    const Network& t_network,
     const std::vector<std::vector<T>>& t_initial_state,
     const std::vector<std::vector<T>>& t_params,
     const std::vector<T>& t_dts
 ) {
     /*
-    t_weighted_edge_list: (N, N), adjacency matrix wegithed by coupling constant
+    t_network: weighted edge list, CSR, dense matrix or mean-field of the network
     t_state: (2, N), phase, dphase of each node
     t_params: (3, N), node features of power, gamma, mass
     t_dts: (S, ), dt for each time step
@@ -196,22 +615,22 @@ std::vector<std::vector<T>> solve_rk1(
 
     std::vector<std::vector<T>> state = t_initial_state;
     for (const auto& dt : t_dts) {
-        state = step_rk1(t_weighted_edge_list, state, t_params, dt);
+        state = step_rk1(t_network, state, t_params, dt);
         trajectory.emplace_back(LinearAlgebra::flatten(state));
     }
 
     return trajectory;
 }
 
-template <typename T>
+template <typename T, typename Network>
 std::vector<std::vector<T>> solve_rk2(
-    const std::vector<WeightedEdge<T>>& t_weighted_edge_list,
+    const Network& t_network,
     const std::vector<std::vector<T>>& t_initial_state,
     const std::vector<std::vector<T>>& t_params,
     const std::vector<T>& t_dts
 ) {
     /*
-    t_weighted_edge_list: (N, N), adjacency matrix wegithed by coupling constant
+    t_network: weighted edge list, CSR, dense matrix or mean-field of the network
     t_state: (2, N), phase, dphase of each node
     t_params: (3, N), node features of power, gamma, mass
     t_dts: (S, ), dt for each time step
@@ -226,22 +645,22 @@ std::vector<std::vector<T>> solve_rk2(
 
     std::vector<std::vector<T>> state = t_initial_state;
     for (const auto& dt : t_dts) {
-        state = step_rk2(t_weighted_edge_list, state, t_params, dt);
+        state = step_rk2(t_network, state, t_params, dt);
         trajectory.emplace_back(LinearAlgebra::flatten(state));
     }
 
     return trajectory;
 }
 
-template <typename T>
+template <typename T, typename Network>
 std::vector<std::vector<T>> solve_rk4(
-    const std::vector<WeightedEdge<T>>& t_weighted_edge_list,
+    const Network& t_network,
     const std::vector<std::vector<T>>& t_initial_state,
     const std::vector<std::vector<T>>& t_params,
     const std::vector<T>& t_dts
 ) {
     /*
-    t_weighted_edge_list: (E,) If (0, 1) is at edge_list, (1, 0) is not
+    t_network: weighted edge list, CSR, dense matrix or mean-field of the network
     t_state: (2, N), phase, dphase of each node
     t_params: (3, N), node features of power, gamma, mass
     t_dts: (S, ), dt for each time step
@@ -256,11 +675,1624 @@ std::vector<std::vector<T>> solve_rk4(
 
     std::vector<std::vector<T>> state = t_initial_state;
     for (const auto& dt : t_dts) {
-        state = step_rk4(t_weighted_edge_list, state, t_params, dt);
+        state = step_rk4(t_network, state, t_params, dt);
+        trajectory.emplace_back(LinearAlgebra::flatten(state));
+    }
+
+    return trajectory;
+}
+
+/*
+Coefficients of low-storage (2N) Runge-Kutta method of Williamson form
+    dq = a_s * dq + dt * f(y)
+    y = y + b_s * dq
+for each stage s. Only the state y and a single register dq are kept per variable
+- lsrk3: Williamson (1980), 3 stages, 3rd order
+- lsrk4: Carpenter and Kennedy (1994), 5 stages, 4th order
+*/
+struct LowStorageTableau {
+    std::vector<double> a;
+    std::vector<double> b;
+
+    const Count get_num_stages() const { return a.size(); }
+};
+
+const LowStorageTableau get_low_storage_tableau(const std::string& t_solver_name) {
+    if (t_solver_name.find("lsrk3") != std::string::npos) {
+        return {
+            {0.0, -5.0 / 9.0, -153.0 / 128.0},
+            {1.0 / 3.0, 15.0 / 16.0, 8.0 / 15.0}};
+    }
+    return {
+        {0.0,
+         -567301805773.0 / 1357537059087.0,
+         -2404267990393.0 / 2016746695238.0,
+         -3550918686646.0 / 2091501179385.0,
+         -1275806237668.0 / 842570457699.0},
+        {1432997174477.0 / 9575080441755.0,
+         5161836677717.0 / 13612068292357.0,
+         1720146321549.0 / 2090206949498.0,
+         3134564353537.0 / 4481467310338.0,
+         2277821191437.0 / 14882151754819.0}};
+}
+
+/* Single low-storage step, updating state in place. t_register: (2, N) of any
+value, overwritten by the first stage */
+template <typename T, typename Network>
+void step_low_storage(
+    const Network& t_network,
+    std::vector<std::vector<T>>& t_state,
+    std::vector<std::vector<T>>& t_register,
+    const std::vector<std::vector<T>>& t_params,
+    const LowStorageTableau& t_tableau,
+    const T& dt
+) {
+    SWING_PROFILE_SCOPE("step");
+    const Count num_nodes = t_state[0].size();
+
+    for (Count stage = 0; stage < t_tableau.get_num_stages(); ++stage) {
+        const std::vector<T> acceleration =
+            get_acceleration(t_network, t_state, t_params);
+
+        SWING_PROFILE_SCOPE("combine");
+        const T a = t_tableau.a[stage], b = t_tableau.b[stage];
+        T* phase = t_state[0].data();
+        T* dphase = t_state[1].data();
+        T* phase_register = t_register[0].data();
+        T* dphase_register = t_register[1].data();
+        if (stage == 0) {
+            // a_0 = 0: register is not read, so that it needs no initialization
+#pragma omp simd
+            for (Node node = 0; node < num_nodes; ++node) {
+                phase_register[node] = dt * dphase[node];
+                dphase_register[node] = dt * acceleration[node];
+                phase[node] += b * phase_register[node];
+                dphase[node] += b * dphase_register[node];
+            }
+        } else {
+#pragma omp simd
+            for (Node node = 0; node < num_nodes; ++node) {
+                phase_register[node] = a * phase_register[node] + dt * dphase[node];
+                dphase_register[node] =
+                    a * dphase_register[node] + dt * acceleration[node];
+                phase[node] += b * phase_register[node];
+                dphase[node] += b * dphase_register[node];
+            }
+        }
+    }
+}
+
+template <typename T, typename Network>
+std::vector<std::vector<T>> solve_low_storage(
+    const std::string& t_solver_name,
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_initial_state,
+    const std::vector<std::vector<T>>& t_params,
+    const std::vector<T>& t_dts
+) {
+    /*
+    Low-storage Runge-Kutta of Williamson form, see LowStorageTableau
+
+    Each stage streams state and register once, fused with the acceleration, so
+    that a step keeps 4 vectors of N alive in addition to the acceleration instead
+    of the 8 velocities and accelerations and temporary states of rk4
+
+    Return
+    (S+1, 2 * N), phase1, ... phaseN, dphase1,...,dphaseN at each time step
+    */
+
+    const LowStorageTableau tableau = get_low_storage_tableau(t_solver_name);
+    const Count num_nodes = t_initial_state[0].size();
+
+    std::vector<std::vector<T>> trajectory;  // (S+1, 2*N)
+    trajectory.reserve(t_dts.size() + 1);
+    trajectory.emplace_back(LinearAlgebra::flatten(t_initial_state));
+
+    std::vector<std::vector<T>> state = t_initial_state;
+    std::vector<std::vector<T>> register_state = {
+        std::vector<T>(num_nodes), std::vector<T>(num_nodes)};
+    for (const auto& dt : t_dts) {
+        step_low_storage(t_network, state, register_state, t_params, tableau, dt);
         trajectory.emplace_back(LinearAlgebra::flatten(state));
     }
 
     return trajectory;
 }
 
+/*
+Exact flow of d dphase / dt = -gamma / mass * dphase + a over a duration h, with
+constant acceleration a of the conservative part: dphase <- decay * dphase + kick * a
+decay = exp(-c h), kick = (1 - exp(-c h)) / c with c = gamma / mass, h at gamma = 0
+*/
+template <typename T>
+struct DampedKick {
+    std::vector<T> decay;
+    std::vector<T> kick;
+
+    DampedKick() {}
+    DampedKick(const std::vector<std::vector<T>>& t_params, const double& t_duration) {
+        const Count num_nodes = t_params[0].size();
+        decay.resize(num_nodes);
+        kick.resize(num_nodes);
+        for (Node node = 0; node < num_nodes; ++node) {
+            const double rate = (double)t_params[1][node] / t_params[2][node];
+            const double decrement = std::expm1(-rate * t_duration);
+            decay[node] = 1.0 + decrement;
+            kick[node] = rate != 0.0 ? -decrement / rate : t_duration;
+        }
+    }
+};
+
+/*
+Single damped velocity Verlet step, updating state and cached acceleration in place
+
+t_conservative_params: (3, N), power, zero gamma, mass: acceleration without damping
+t_acceleration: acceleration of conservative params at current phase, replaced by
+    that of the next phase (first same as last)
+t_half_kick: DampedKick of dt / 2
+*/
+template <typename T, typename Network>
+void step_verlet(
+    const Network& t_network,
+    std::vector<std::vector<T>>& t_state,
+    std::vector<T>& t_acceleration,
+    const std::vector<std::vector<T>>& t_conservative_params,
+    const DampedKick<T>& t_half_kick,
+    const T& dt
+) {
+    SWING_PROFILE_SCOPE("step");
+    const Count num_nodes = t_state[0].size();
+    const T* decay = t_half_kick.decay.data();
+    const T* kick = t_half_kick.kick.data();
+    T* phase = t_state[0].data();
+    T* dphase = t_state[1].data();
+    {
+        // Half kick, drift
+        SWING_PROFILE_SCOPE("combine");
+        const T* acceleration = t_acceleration.data();
+#pragma omp simd
+        for (Node node = 0; node < num_nodes; ++node) {
+            dphase[node] = decay[node] * dphase[node] + kick[node] * acceleration[node];
+            phase[node] += dt * dphase[node];
+        }
+    }
+    t_acceleration = get_acceleration(t_network, t_state, t_conservative_params);
+
+    // Half kick
+    SWING_PROFILE_SCOPE("combine");
+    const T* acceleration = t_acceleration.data();
+#pragma omp simd
+    for (Node node = 0; node < num_nodes; ++node) {
+        dphase[node] = decay[node] * dphase[node] + kick[node] * acceleration[node];
+    }
+}
+
+/*
+Single damped leapfrog (drift, kick, drift) step, updating state in place
+t_kick: DampedKick of dt
+*/
+template <typename T, typename Network>
+void step_leapfrog(
+    const Network& t_network,
+    std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_conservative_params,
+    const DampedKick<T>& t_kick,
+    const T& dt
+) {
+    SWING_PROFILE_SCOPE("step");
+    const Count num_nodes = t_state[0].size();
+    const T half_dt = 0.5 * dt;
+    const T* decay = t_kick.decay.data();
+    const T* kick = t_kick.kick.data();
+    T* phase = t_state[0].data();
+    T* dphase = t_state[1].data();
+    {
+        SWING_PROFILE_SCOPE("combine");
+#pragma omp simd
+        for (Node node = 0; node < num_nodes; ++node) {
+            phase[node] += half_dt * dphase[node];
+        }
+    }
+    const std::vector<T> acceleration =
+        get_acceleration(t_network, t_state, t_conservative_params);
+
+    // Kick, drift
+    SWING_PROFILE_SCOPE("combine");
+#pragma omp simd
+    for (Node node = 0; node < num_nodes; ++node) {
+        dphase[node] = decay[node] * dphase[node] + kick[node] * acceleration[node];
+        phase[node] += half_dt * dphase[node];
+    }
+}
+
+/* Power, zero gamma, mass: get_acceleration without the damping term */
+template <typename T>
+std::vector<std::vector<T>> get_conservative_params(
+    const std::vector<std::vector<T>>& t_params
+) {
+    return {t_params[0], std::vector<T>(t_params[1].size(), 0.0), t_params[2]};
+}
+
+template <typename T, typename Network>
+std::vector<std::vector<T>> solve_verlet(
+    const std::string& t_solver_name,
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_initial_state,
+    const std::vector<std::vector<T>>& t_params,
+    const std::vector<T>& t_dts
+) {
+    /*
+    Second order splitting with a single get_acceleration per step
+
+    Drift of phase alternates with kicks of dphase, where a kick is the exact
+    solution of the damped dphase under the acceleration of the conservative part
+    (DampedKick). The scheme is symmetric, stable for any gamma * dt / m and
+    keeps synchronous states rotating at any frequency exactly
+    - verlet: velocity Verlet (half kick, drift, half kick), acceleration at the
+      end of a step is reused at the start of the next one
+    - leapfrog: position Verlet (half drift, kick, half drift)
+
+    Return
+    (S+1, 2 * N), phase1, ... phaseN, dphase1,...,dphaseN at each time step
+    */
+
+    const bool leapfrog = t_solver_name.find("leapfrog") != std::string::npos;
+    const std::vector<std::vector<T>> conservative_params =
+        get_conservative_params(t_params);
+
+    std::vector<std::vector<T>> trajectory;  // (S+1, 2*N)
+    trajectory.reserve(t_dts.size() + 1);
+    trajectory.emplace_back(LinearAlgebra::flatten(t_initial_state));
+
+    std::vector<std::vector<T>> state = t_initial_state;
+    std::vector<T> acceleration;
+    if (not leapfrog) {
+        acceleration = get_acceleration(t_network, state, conservative_params);
+    }
+
+    // Kick is computed again only when dt changes
+    DampedKick<T> kick;
+    T kick_dt = 0.0;
+    for (const auto& dt : t_dts) {
+        if (kick.kick.empty() || dt != kick_dt) {
+            kick = DampedKick<T>(t_params, leapfrog ? (double)dt : 0.5 * dt);
+            kick_dt = dt;
+        }
+        if (leapfrog) {
+            step_leapfrog(t_network, state, conservative_params, kick, dt);
+        } else {
+            step_verlet(t_network, state, acceleration, conservative_params, kick, dt);
+        }
+        trajectory.emplace_back(LinearAlgebra::flatten(state));
+    }
+
+    return trajectory;
+}
+
+/*
+Exact flow of the local part m * d^2 theta / dt^2 = P - gamma * d theta / dt of
+each node over a duration h. With c = gamma / m and a = P / m
+    dphase <- decay * dphase + velocity_drive
+    phase <- phase + drift * dphase + phase_drive
+where decay = exp(-c h), drift = (1 - exp(-c h)) / c, velocity_drive = drift * a
+and phase_drive = (c h - 1 + exp(-c h)) / c^2 * a, i.e., dphase relaxes to P / gamma.
+At gamma = 0, drift = h and phase_drive = a h^2 / 2
+*/
+template <typename T>
+struct LocalFlow {
+    std::vector<T> decay;
+    std::vector<T> drift;
+    std::vector<T> phase_drive;
+    std::vector<T> velocity_drive;
+
+    LocalFlow() {}
+    LocalFlow(const std::vector<std::vector<T>>& t_params, const double& t_duration) {
+        const Count num_nodes = t_params[0].size();
+        decay.resize(num_nodes);
+        drift.resize(num_nodes);
+        phase_drive.resize(num_nodes);
+        velocity_drive.resize(num_nodes);
+        for (Node node = 0; node < num_nodes; ++node) {
+            const double rate = (double)t_params[1][node] / t_params[2][node];
+            const double drive = (double)t_params[0][node] / t_params[2][node];
+            const double x = rate * t_duration;
+            const double decrement = std::expm1(-x);
+
+            // (x - 1 + exp(-x)) / x^2 cancels at small x: Taylor series instead
+            double phase_factor = 0.0;
+            if (std::abs(x) < 0.1) {
+                double term = 0.5;
+                for (int k = 0; k < 10; ++k) {
+                    phase_factor += term;
+                    term *= -x / (k + 3);
+                }
+            } else {
+                phase_factor = (x + decrement) / (x * x);
+            }
+
+            decay[node] = 1.0 + decrement;
+            drift[node] = x != 0.0 ? -decrement / rate : t_duration;
+            phase_drive[node] = phase_factor * t_duration * t_duration * drive;
+            velocity_drive[node] = drift[node] * drive;
+        }
+    }
+
+    /* Advance phase, dphase in place */
+    void apply(std::vector<std::vector<T>>& t_state) const {
+        const Count num_nodes = t_state[0].size();
+        T* phase = t_state[0].data();
+        T* dphase = t_state[1].data();
+#pragma omp simd
+        for (Node node = 0; node < num_nodes; ++node) {
+            phase[node] += drift[node] * dphase[node] + phase_drive[node];
+            dphase[node] = decay[node] * dphase[node] + velocity_drive[node];
+        }
+    }
+};
+
+/*
+Single Strang splitting step, updating state in place: half step of the local
+flow, full step of the coupling, half step of the local flow
+
+t_coupling_params: (3, N), zero power, zero gamma, mass: get_acceleration is the
+    coupling alone
+t_half_flow: LocalFlow of dt / 2
+*/
+template <typename T, typename Network>
+void step_strang(
+    const Network& t_network,
+    std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_coupling_params,
+    const LocalFlow<T>& t_half_flow,
+    const T& dt
+) {
+    SWING_PROFILE_SCOPE("step");
+    const Count num_nodes = t_state[0].size();
+    {
+        SWING_PROFILE_SCOPE("combine");
+        t_half_flow.apply(t_state);
+    }
+    const std::vector<T> acceleration =
+        get_acceleration(t_network, t_state, t_coupling_params);
+
+    // Phase is constant under the coupling: its exact flow is a single kick
+    SWING_PROFILE_SCOPE("combine");
+    T* dphase = t_state[1].data();
+#pragma omp simd
+    for (Node node = 0; node < num_nodes; ++node) {
+        dphase[node] += dt * acceleration[node];
+    }
+    t_half_flow.apply(t_state);
+}
+
+template <typename T, typename Network>
+std::vector<std::vector<T>> solve_strang(
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_initial_state,
+    const std::vector<std::vector<T>>& t_params,
+    const std::vector<T>& t_dts
+) {
+    /*
+    Strang splitting of the linear local part, solved exactly per node
+    (LocalFlow), and the nonlinear coupling. With frozen phases the coupling is
+    constant, so that its explicit step is exact and costs a single
+    get_acceleration. Second order, and dt is not limited by gamma / m of heavily
+    damped or light nodes, only by the coupling
+
+    Return
+    (S+1, 2 * N), phase1, ... phaseN, dphase1,...,dphaseN at each time step
+    */
+
+    const Count num_nodes = t_initial_state[0].size();
+    const std::vector<std::vector<T>> coupling_params = {
+        std::vector<T>(num_nodes, 0.0), std::vector<T>(num_nodes, 0.0), t_params[2]};
+
+    std::vector<std::vector<T>> trajectory;  // (S+1, 2*N)
+    trajectory.reserve(t_dts.size() + 1);
+    trajectory.emplace_back(LinearAlgebra::flatten(t_initial_state));
+
+    // Local flow is computed again only when dt changes
+    std::vector<std::vector<T>> state = t_initial_state;
+    LocalFlow<T> half_flow;
+    T flow_dt = 0.0;
+    for (const auto& dt : t_dts) {
+        if (half_flow.decay.empty() || dt != flow_dt) {
+            half_flow = LocalFlow<T>(t_params, 0.5 * dt);
+            flow_dt = dt;
+        }
+        step_strang(t_network, state, coupling_params, half_flow, dt);
+        trajectory.emplace_back(LinearAlgebra::flatten(state));
+    }
+
+    return trajectory;
+}
+
+//* Adams-Bashforth and Adams-Moulton of 4th order
+constexpr Count adams_order = 4;
+using AdamsWeights = std::array<double, adams_order>;
+
+/*
+Weights w_j such that sum_j w_j f(t_j) is the integral from 0 to t_h of the cubic
+interpolating f at t_nodes, relative to the current time. Nodes need not be
+equally spaced, so that variable dt is supported
+*/
+const AdamsWeights get_adams_weights(const AdamsWeights& t_nodes, const double& t_h) {
+    AdamsWeights weights;
+    for (Count j = 0; j < adams_order; ++j) {
+        // Lagrange basis of node j as coefficients of 1, s, s^2, s^3
+        AdamsWeights basis = {1.0, 0.0, 0.0, 0.0};
+        double denominator = 1.0;
+        for (Count k = 0; k < adams_order; ++k) {
+            if (k == j) {
+                continue;
+            }
+            for (Count power = adams_order - 1; power > 0; --power) {
+                basis[power] = basis[power - 1] - t_nodes[k] * basis[power];
+            }
+            basis[0] *= -t_nodes[k];
+            denominator *= t_nodes[j] - t_nodes[k];
+        }
+
+        double integral = 0.0;
+        for (Count power = adams_order; power > 0; --power) {
+            integral = (integral + basis[power - 1] / power) * t_h;
+        }
+        weights[j] = integral / denominator;
+    }
+    return weights;
+}
+
+/* Derivative of the state, i.e., dphase and acceleration, copied into t_derivative */
+template <typename T, typename Network>
+void get_derivative(
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params,
+    std::vector<std::vector<T>>& t_derivative
+) {
+    const std::vector<T> acceleration = get_acceleration(t_network, t_state, t_params);
+    std::copy(t_state[1].begin(), t_state[1].end(), t_derivative[0].begin());
+    std::copy(acceleration.begin(), acceleration.end(), t_derivative[1].begin());
+}
+
+/*
+Ring buffer of the last adams_order derivatives and their times. Slots are
+allocated once, push returns the oldest slot to be overwritten
+*/
+template <typename T>
+class DerivativeHistory {
+   public:
+    DerivativeHistory(const Count& t_num_nodes) {
+        m_slots.assign(
+            adams_order,
+            {std::vector<T>(t_num_nodes), std::vector<T>(t_num_nodes)}
+        );
+    }
+
+    std::vector<std::vector<T>>& push(const double& t_time) {
+        m_newest = (m_newest + 1) % adams_order;
+        m_size = std::min(m_size + 1, adams_order);
+        m_times[m_newest] = t_time;
+        return m_slots[m_newest];
+    }
+
+    /* lag 0 is the newest */
+    const std::vector<std::vector<T>>& get(const Count& t_lag) const {
+        return m_slots[(m_newest + adams_order - t_lag) % adams_order];
+    }
+    const double get_time(const Count& t_lag) const {
+        return m_times[(m_newest + adams_order - t_lag) % adams_order];
+    }
+    const bool is_full() const { return m_size == adams_order; }
+
+   private:
+    std::vector<std::vector<std::vector<T>>> m_slots;  // (K, 2, N)
+    AdamsWeights m_times = {};
+    Count m_newest = adams_order - 1;
+    Count m_size = 0;
+};
+
+/* t_target = t_state + sum_j t_weights[j] * t_derivatives[j] */
+template <typename T>
+void add_weighted_derivatives(
+    std::vector<std::vector<T>>& t_target,
+    const std::vector<std::vector<T>>& t_state,
+    const AdamsWeights& t_weights,
+    const std::array<const std::vector<std::vector<T>>*, adams_order>& t_derivatives
+) {
+    SWING_PROFILE_SCOPE("combine");
+    const Count num_nodes = t_state[0].size();
+    const T w0 = t_weights[0], w1 = t_weights[1];
+    const T w2 = t_weights[2], w3 = t_weights[3];
+    for (int row = 0; row < 2; ++row) {
+        const T* f0 = (*t_derivatives[0])[row].data();
+        const T* f1 = (*t_derivatives[1])[row].data();
+        const T* f2 = (*t_derivatives[2])[row].data();
+        const T* f3 = (*t_derivatives[3])[row].data();
+        const T* state = t_state[row].data();
+        T* target = t_target[row].data();
+#pragma omp simd
+        for (Node node = 0; node < num_nodes; ++node) {
+            target[node] = state[node] + (w0 * f0[node] + w1 * f1[node] +
+                                          w2 * f2[node] + w3 * f3[node]);
+        }
+    }
+}
+
+/*
+Single Adams step from a full history, updating state and history in place
+t_next_state, t_predicted_derivative: (2, N) buffers of any value
+*/
+template <typename T, typename Network>
+void step_adams(
+    const Network& t_network,
+    std::vector<std::vector<T>>& t_state,
+    std::vector<std::vector<T>>& t_next_state,
+    std::vector<std::vector<T>>& t_predicted_derivative,
+    DerivativeHistory<T>& t_history,
+    const std::vector<std::vector<T>>& t_params,
+    const double& t_time,
+    const T& dt,
+    const bool& t_corrector
+) {
+    SWING_PROFILE_SCOPE("step");
+
+    // Predict
+    AdamsWeights nodes;
+    for (Count lag = 0; lag < adams_order; ++lag) {
+        nodes[lag] = t_history.get_time(lag) - t_time;
+    }
+    add_weighted_derivatives(
+        t_next_state,
+        t_state,
+        get_adams_weights(nodes, dt),
+        {&t_history.get(0), &t_history.get(1), &t_history.get(2), &t_history.get(3)}
+    );
+
+    // Evaluate, correct
+    if (t_corrector) {
+        get_derivative(t_network, t_next_state, t_params, t_predicted_derivative);
+        add_weighted_derivatives(
+            t_next_state,
+            t_state,
+            get_adams_weights({dt, nodes[0], nodes[1], nodes[2]}, dt),
+            {&t_predicted_derivative,
+             &t_history.get(0),
+             &t_history.get(1),
+             &t_history.get(2)}
+        );
+    }
+    std::swap(t_state, t_next_state);
+
+    // Evaluate
+    get_derivative(t_network, t_state, t_params, t_history.push(t_time + dt));
+}
+
+template <typename T, typename Network>
+std::vector<std::vector<T>> solve_adams(
+    const std::string& t_solver_name,
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_initial_state,
+    const std::vector<std::vector<T>>& t_params,
+    const std::vector<T>& t_dts
+) {
+    /*
+    4th order linear multistep methods reusing past derivatives, the first
+    adams_order - 1 steps bootstrapped by rk4
+    - ab4: Adams-Bashforth, a single get_acceleration per step
+    - abm4: Adams-Bashforth predictor and Adams-Moulton corrector (PECE), two
+      get_acceleration per step, smaller error and larger stability region
+    Weights are computed from the actual times of the history at every step, so
+    that dts may vary
+
+    Return
+    (S+1, 2 * N), phase1, ... phaseN, dphase1,...,dphaseN at each time step
+    */
+
+    const bool corrector = t_solver_name.find("abm") != std::string::npos;
+    const Count num_nodes = t_initial_state[0].size();
+
+    std::vector<std::vector<T>> trajectory;  // (S+1, 2*N)
+    trajectory.reserve(t_dts.size() + 1);
+    trajectory.emplace_back(LinearAlgebra::flatten(t_initial_state));
+
+    std::vector<std::vector<T>> state = t_initial_state;
+    std::vector<std::vector<T>> next_state = t_initial_state;
+    std::vector<std::vector<T>> predicted_derivative = t_initial_state;
+    DerivativeHistory<T> history(num_nodes);
+    double time = 0.0;
+    get_derivative(t_network, state, t_params, history.push(time));
+
+    for (const auto& dt : t_dts) {
+        if (history.is_full()) {
+            step_adams(
+                t_network,
+                state,
+                next_state,
+                predicted_derivative,
+                history,
+                t_params,
+                time,
+                dt,
+                corrector
+            );
+        } else {
+            state = step_rk4(t_network, state, t_params, dt);
+            get_derivative(t_network, state, t_params, history.push(time + dt));
+        }
+        time += dt;
+        trajectory.emplace_back(LinearAlgebra::flatten(state));
+    }
+
+    return trajectory;
+}
+
+/* Implicit solver needs the Jacobian of CSR network */
+template <typename T, typename Network>
+std::vector<std::vector<T>> solve_bdf2(
+    const Network&,
+    const std::vector<std::vector<T>>&,
+    const std::vector<std::vector<T>>&,
+    const std::vector<T>&
+) {
+    std::cout << "Implicit solver bdf2 needs csr network\n";
+    exit(1);
+}
+
+template <typename T, typename I>
+std::vector<std::vector<T>> solve_bdf2(
+    const CSR<T, I>& t_csr,
+    const std::vector<std::vector<T>>& t_initial_state,
+    const std::vector<std::vector<T>>& t_params,
+    const std::vector<T>& t_dts
+) {
+    /*
+    Variable step BDF2, the first step by backward Euler, with Newton-Krylov
+
+    With r = h_n / h_{n-1}, each step solves
+        y_{n+1} = c0 * y_n - c1 * y_{n-1} + beta * f(y_{n+1})
+    c0 = (1+r)^2 / (1+2r), c1 = r^2 / (1+2r), beta = h_n (1+r) / (1+2r)
+    Substituting dphase = (phase - a_phase) / beta, where a = c0 * y_n - c1 * y_{n-1},
+    leaves N equations of phase alone
+        G = D (phase - a_phase) - m a_dphase / beta - P - interaction(phase) = 0
+    with D = (m + beta gamma) / beta^2. Its Jacobian D + L_cos is symmetric
+    (krylov.hpp), so that each Newton iteration solves it by Jacobi
+    preconditioned conjugate gradient. A-stable: dt is limited by accuracy, not
+    by light or heavily damped nodes
+
+    Return
+    (S+1, 2 * N), phase1, ... phaseN, dphase1,...,dphaseN at each time step
+    */
+
+    constexpr int max_newton_iterations = 10;
+    constexpr int max_krylov_iterations = 200;
+    constexpr double krylov_tolerance = 1e-4;
+    const double newton_tolerance = 1e-2 * std::sqrt(std::numeric_limits<T>::epsilon());
+
+    const Count num_nodes = t_initial_state[0].size();
+    const std::vector<T>& power = t_params[0];
+    const std::vector<T>& gamma = t_params[1];
+    const std::vector<T>& mass = t_params[2];
+
+    // get_acceleration of zero power, gamma and unit mass is the interaction alone
+    const std::vector<std::vector<T>> coupling_params = {
+        std::vector<T>(num_nodes, 0.0),
+        std::vector<T>(num_nodes, 0.0),
+        std::vector<T>(num_nodes, 1.0)};
+    std::vector<std::vector<T>> phase_state = {
+        t_initial_state[0], std::vector<T>(num_nodes, 0.0)};
+    std::vector<T>& phase = phase_state[0];
+
+    std::vector<std::vector<T>> trajectory;  // (S+1, 2*N)
+    trajectory.reserve(t_dts.size() + 1);
+    trajectory.emplace_back(LinearAlgebra::flatten(t_initial_state));
+
+    std::vector<std::vector<T>> state = t_initial_state;
+    std::vector<std::vector<T>> previous_state = t_initial_state;
+    std::vector<std::vector<T>> history = t_initial_state;  // a of BDF2
+    std::vector<T> diagonal(num_nodes), inverse_diagonal(num_nodes);
+    std::vector<T> residual(num_nodes), newton_step(num_nodes);
+    Count num_failures = 0;
+    T previous_dt = 0.0;
+    for (const auto& dt : t_dts) {
+        SWING_PROFILE_SCOPE("step");
+
+        //* History of BDF2, backward Euler at the first step
+        double c0 = 1.0, c1 = 0.0, beta = dt;
+        if (previous_dt > 0.0) {
+            const double r = (double)dt / previous_dt;
+            c0 = (1.0 + r) * (1.0 + r) / (1.0 + 2.0 * r);
+            c1 = r * r / (1.0 + 2.0 * r);
+            beta = dt * (1.0 + r) / (1.0 + 2.0 * r);
+        }
+        for (int row = 0; row < 2; ++row) {
+            for (Node node = 0; node < num_nodes; ++node) {
+                history[row][node] =
+                    c0 * state[row][node] - c1 * previous_state[row][node];
+            }
+        }
+        for (Node node = 0; node < num_nodes; ++node) {
+            diagonal[node] = (mass[node] + beta * gamma[node]) / (beta * beta);
+            phase[node] = state[0][node] + dt * state[1][node];  // Predictor
+        }
+
+        //* Newton iterations
+        bool converged = false;
+        for (int iteration = 0; iteration < max_newton_iterations; ++iteration) {
+            const std::vector<T> interaction =
+                get_acceleration(t_csr, phase_state, coupling_params);
+            for (Node node = 0; node < num_nodes; ++node) {
+                residual[node] = -(
+                    diagonal[node] * (phase[node] - history[0][node]) -
+                    mass[node] * history[1][node] / beta - power[node] -
+                    interaction[node]
+                );
+            }
+
+            // Jacobi preconditioner, D alone where the diagonal of L_cos makes it
+            // non-positive
+            const CosineLaplacian<T, I> laplacian(t_csr, phase);
+            const std::vector<T>& laplacian_diagonal = laplacian.get_diagonal();
+            for (Node node = 0; node < num_nodes; ++node) {
+                const T jacobian = diagonal[node] + laplacian_diagonal[node];
+                inverse_diagonal[node] =
+                    1.0 / (jacobian > 0.0 ? jacobian : diagonal[node]);
+            }
+            std::fill(newton_step.begin(), newton_step.end(), 0.0);
+            solve_conjugate_gradient(
+                [&](const std::vector<T>& t_vector, std::vector<T>& t_result) {
+                    laplacian.apply(t_vector, t_result);
+                    for (Node node = 0; node < num_nodes; ++node) {
+                        t_result[node] += diagonal[node] * t_vector[node];
+                    }
+                },
+                inverse_diagonal,
+                residual,
+                newton_step,
+                krylov_tolerance,
+                max_krylov_iterations
+            );
+
+            double step_norm = 0.0, phase_norm = 1.0;
+            for (Node node = 0; node < num_nodes; ++node) {
+                phase[node] += newton_step[node];
+                step_norm = std::max(step_norm, std::abs((double)newton_step[node]));
+                phase_norm = std::max(phase_norm, std::abs((double)phase[node]));
+            }
+            if (step_norm <= newton_tolerance * phase_norm) {
+                converged = true;
+                break;
+            }
+        }
+        num_failures += not converged;
+
+        //* dphase from the converged phase
+        std::swap(previous_state, state);
+        for (Node node = 0; node < num_nodes; ++node) {
+            state[0][node] = phase[node];
+            state[1][node] = (phase[node] - history[0][node]) / beta;
+        }
+        previous_dt = dt;
+        trajectory.emplace_back(LinearAlgebra::flatten(state));
+    }
+
+    if (num_failures > 0) {
+        std::cerr << "bdf2: Newton did not converge at " << num_failures << " of "
+                  << t_dts.size() << " steps\n";
+    }
+    return trajectory;
+}
+
+//* Multirate rk4
+// Nodes with rate * dt above the threshold are fast, well inside the stability
+// region of rk4 (2.78 on the negative real axis)
+constexpr double multirate_threshold = 1.0;
+
+/* sum_j |K_ij| of each node: the largest interaction its edges can carry */
+template <typename T, typename I>
+std::vector<double> get_total_coupling(const CSR<T, I>& t_csr) {
+    std::vector<double> coupling(t_csr.num_nodes, 0.0);
+    for (Node node = 0; node < t_csr.num_nodes; ++node) {
+        for (I idx = t_csr.offsets[node]; idx < t_csr.offsets[node + 1]; ++idx) {
+            coupling[node] +=
+                t_csr.is_unit_weight() ? 1.0 : std::abs(t_csr.weights[idx]);
+        }
+    }
+    return coupling;
+}
+
+/*
+Rate of the fastest local dynamics of each node
+max(gamma / m, sqrt(sum_j |K_ij| / m)): relaxation by damping and oscillation
+against neighbors held fixed
+*/
+template <typename T, typename I>
+std::vector<double> get_local_rates(
+    const CSR<T, I>& t_csr,
+    const std::vector<std::vector<T>>& t_params
+) {
+    const Count num_nodes = t_params[0].size();
+    const std::vector<double> coupling = get_total_coupling(t_csr);
+    std::vector<double> rates(num_nodes);
+    for (Node node = 0; node < num_nodes; ++node) {
+        const double mass = t_params[2][node];
+        rates[node] = std::max(
+            std::abs((double)t_params[1][node]) / mass, std::sqrt(coupling[node] / mass)
+        );
+    }
+    return rates;
+}
+
+/*
+Partition of nodes for a macro step dt. Fast nodes take num_substeps substeps
+slow_boundary: fast neighbors of slow nodes, fast_boundary: slow neighbors of fast
+nodes. fast_index: position of each fast node at fast
+*/
+struct MultiratePartition {
+    std::vector<Node> slow;
+    std::vector<Node> fast;
+    std::vector<Node> slow_boundary;
+    std::vector<Node> fast_boundary;
+    std::vector<Count> fast_index;
+    Count num_substeps = 1;
+
+    MultiratePartition() {}
+    template <typename T, typename I>
+    MultiratePartition(
+        const CSR<T, I>& t_csr,
+        const std::vector<double>& t_rates,
+        const double& t_dt
+    ) {
+        const Count num_nodes = t_rates.size();
+        fast_index.assign(num_nodes, num_nodes);
+        double max_rate = 0.0;
+        for (Node node = 0; node < num_nodes; ++node) {
+            if (t_rates[node] * t_dt > multirate_threshold) {
+                fast_index[node] = fast.size();
+                fast.emplace_back(node);
+                max_rate = std::max(max_rate, t_rates[node]);
+            } else {
+                slow.emplace_back(node);
+            }
+        }
+        num_substeps = std::max(1.0, std::ceil(max_rate * t_dt / multirate_threshold));
+
+        std::vector<bool> is_boundary(num_nodes, false);
+        for (Node node = 0; node < num_nodes; ++node) {
+            const bool is_fast = fast_index[node] < num_nodes;
+            for (I idx = t_csr.offsets[node]; idx < t_csr.offsets[node + 1]; ++idx) {
+                const Node neighbor = t_csr.neighbors[idx];
+                if (is_fast != (fast_index[neighbor] < num_nodes)) {
+                    is_boundary[neighbor] = true;
+                }
+            }
+        }
+        for (Node node = 0; node < num_nodes; ++node) {
+            if (is_boundary[node]) {
+                (fast_index[node] < num_nodes ? slow_boundary : fast_boundary)
+                    .emplace_back(node);
+            }
+        }
+    }
+};
+
+/* Multirate solver needs the rows of CSR network */
+template <typename T, typename Network>
+std::vector<std::vector<T>> solve_multirate(
+    const Network&,
+    const std::vector<std::vector<T>>&,
+    const std::vector<std::vector<T>>&,
+    const std::vector<T>&
+) {
+    std::cout << "Multirate solver needs csr network\n";
+    exit(1);
+}
+
+template <typename T, typename I>
+std::vector<std::vector<T>> solve_multirate(
+    const CSR<T, I>& t_csr,
+    const std::vector<std::vector<T>>& t_initial_state,
+    const std::vector<std::vector<T>>& t_params,
+    const std::vector<T>& t_dts
+) {
+    /*
+    Multirate rk4, fastest first
+
+    Nodes whose local rate (get_local_rates) times dt exceeds multirate_threshold
+    are fast, and take num_substeps rk4 substeps per macro step dt. Accelerations
+    are computed for the rows of a class alone (get_acceleration_subset), with sin,
+    cos of the class and its boundary
+    1. Acceleration of every node at the start of the macro step: first stage of
+       slow nodes and of the first substep of fast nodes
+    2. Substeps of fast nodes, where phases of slow neighbors are extrapolated
+       theta + dtheta s + a s^2 / 2 + j s^3 / 6, with jerk j from the acceleration
+       of the previous macro step
+    3. Stages of slow nodes, where phases of fast neighbors are cubic Hermite
+       interpolation of the stored substeps
+    Without fast nodes, this is rk4 as is
+
+    Return
+    (S+1, 2 * N), phase1, ... phaseN, dphase1,...,dphaseN at each time step
+    */
+
+    const Count num_nodes = t_initial_state[0].size();
+    const std::vector<double> rates = get_local_rates(t_csr, t_params);
+
+    std::vector<std::vector<T>> trajectory;  // (S+1, 2*N)
+    trajectory.reserve(t_dts.size() + 1);
+    trajectory.emplace_back(LinearAlgebra::flatten(t_initial_state));
+
+    std::vector<std::vector<T>> state = t_initial_state;
+    std::vector<T> phase(num_nodes), dphase(num_nodes);  // Stage values
+    std::vector<T> sin_phase(num_nodes), cos_phase(num_nodes);
+    std::vector<T> acceleration, previous_acceleration;
+    std::vector<T> jerk(num_nodes);
+    T previous_dt = 0.0;
+
+    // Buffers of fast and slow nodes, sized when the partition changes
+    std::vector<std::vector<T>> fast_phases, fast_dphases;  // (substeps+1, F)
+    std::vector<T> stage_phase, stage_dphase, phase_sum, dphase_sum;
+    std::vector<T> stage_acceleration;
+    std::vector<T> slow_phase, slow_dphase, slow_stage_phase, slow_stage_dphase;
+    std::vector<T> slow_phase_sum, slow_dphase_sum, slow_acceleration;
+
+    MultiratePartition partition;
+    T partition_dt = 0.0;
+    for (const auto& dt : t_dts) {
+        SWING_PROFILE_SCOPE("step");
+        if (partition.fast_index.empty() || dt != partition_dt) {
+            partition = MultiratePartition(t_csr, rates, dt);
+            partition_dt = dt;
+            const Count num_fast = partition.fast.size();
+            fast_phases.assign(partition.num_substeps + 1, std::vector<T>(num_fast));
+            fast_dphases.assign(partition.num_substeps + 1, std::vector<T>(num_fast));
+            for (std::vector<T>* buffer :
+                 {&stage_phase, &stage_dphase, &phase_sum, &dphase_sum,
+                  &stage_acceleration}) {
+                buffer->resize(num_fast);
+            }
+            for (std::vector<T>* buffer :
+                 {&slow_phase, &slow_dphase, &slow_stage_phase, &slow_stage_dphase,
+                  &slow_phase_sum, &slow_dphase_sum, &slow_acceleration}) {
+                buffer->resize(partition.slow.size());
+            }
+        }
+        const std::vector<Node>& slow = partition.slow;
+        const std::vector<Node>& fast = partition.fast;
+        if (fast.empty()) {
+            state = step_rk4(t_csr, state, t_params, dt);
+            previous_dt = 0.0;
+            trajectory.emplace_back(LinearAlgebra::flatten(state));
+            continue;
+        }
+
+        //* 1. Acceleration at the start
+        acceleration = get_acceleration(t_csr, state, t_params);
+        for (const Node& node : partition.fast_boundary) {
+            jerk[node] =
+                previous_dt > 0.0
+                    ? (acceleration[node] - previous_acceleration[node]) / previous_dt
+                    : 0.0;
+        }
+        const auto update_sincos = [&](const std::vector<Node>& t_nodes) {
+            SWING_PROFILE_SCOPE("sincos");
+            for (const Node& node : t_nodes) {
+                sin_phase[node] = std::sin(phase[node]);
+                cos_phase[node] = std::cos(phase[node]);
+            }
+        };
+
+        //* 2. Substeps of fast nodes
+        const Count num_fast = fast.size();
+        const Count num_substeps = partition.num_substeps;
+        const T substep_dt = dt / num_substeps;
+        for (Count k = 0; k < num_fast; ++k) {
+            fast_phases[0][k] = state[0][fast[k]];
+            fast_dphases[0][k] = state[1][fast[k]];
+        }
+
+        // Acceleration of fast nodes at stage values, slow neighbors extrapolated
+        const auto evaluate_fast = [&](const std::vector<T>& t_phase,
+                                       const std::vector<T>& t_dphase,
+                                       const double& t_time,
+                                       std::vector<T>& t_result) {
+            for (Count k = 0; k < num_fast; ++k) {
+                phase[fast[k]] = t_phase[k];
+                dphase[fast[k]] = t_dphase[k];
+            }
+            for (const Node& node : partition.fast_boundary) {
+                phase[node] = state[0][node] +
+                              t_time * (state[1][node] +
+                                        t_time * (acceleration[node] / 2.0 +
+                                                  t_time * jerk[node] / 6.0));
+            }
+            update_sincos(fast);
+            update_sincos(partition.fast_boundary);
+            get_acceleration_subset(
+                t_csr, fast, sin_phase, cos_phase, dphase, t_params, t_result
+            );
+        };
+
+        for (Count substep = 0; substep < num_substeps; ++substep) {
+            const std::vector<T>& phase0 = fast_phases[substep];
+            const std::vector<T>& dphase0 = fast_dphases[substep];
+            const double time = substep * (double)substep_dt;
+            if (substep == 0) {
+                for (Count k = 0; k < num_fast; ++k) {
+                    stage_acceleration[k] = acceleration[fast[k]];
+                }
+            } else {
+                evaluate_fast(phase0, dphase0, time, stage_acceleration);
+            }
+
+            // Classic rk4 stages: weights 1, 2, 2, 1 and offsets 1/2, 1/2, 1
+            const T half_dt = 0.5 * substep_dt;
+            const T offsets[3] = {half_dt, half_dt, substep_dt};
+            const T sum_weights[3] = {2.0, 2.0, 1.0};
+            for (Count k = 0; k < num_fast; ++k) {
+                phase_sum[k] = dphase0[k];
+                dphase_sum[k] = stage_acceleration[k];
+            }
+            for (int stage = 0; stage < 3; ++stage) {
+                for (Count k = 0; k < num_fast; ++k) {
+                    const T velocity = stage == 0 ? dphase0[k] : stage_dphase[k];
+                    stage_phase[k] = phase0[k] + offsets[stage] * velocity;
+                    stage_dphase[k] =
+                        dphase0[k] + offsets[stage] * stage_acceleration[k];
+                }
+                evaluate_fast(
+                    stage_phase, stage_dphase, time + offsets[stage], stage_acceleration
+                );
+                for (Count k = 0; k < num_fast; ++k) {
+                    phase_sum[k] += sum_weights[stage] * stage_dphase[k];
+                    dphase_sum[k] += sum_weights[stage] * stage_acceleration[k];
+                }
+            }
+            for (Count k = 0; k < num_fast; ++k) {
+                fast_phases[substep + 1][k] =
+                    phase0[k] + substep_dt * phase_sum[k] / 6.0;
+                fast_dphases[substep + 1][k] =
+                    dphase0[k] + substep_dt * dphase_sum[k] / 6.0;
+            }
+        }
+
+        //* 3. Stages of slow nodes
+        const Count num_slow = slow.size();
+        const auto evaluate_slow = [&](const std::vector<T>& t_phase,
+                                       const std::vector<T>& t_dphase,
+                                       const double& t_time,
+                                       std::vector<T>& t_result) {
+            for (Count k = 0; k < num_slow; ++k) {
+                phase[slow[k]] = t_phase[k];
+                dphase[slow[k]] = t_dphase[k];
+            }
+            // Cubic Hermite interpolation of the substep containing the time
+            const double position = t_time / substep_dt;
+            const Count substep =
+                std::min((Count)std::max(0.0, std::floor(position)), num_substeps - 1);
+            const double s = position - substep;
+            const double h00 = (1.0 + 2.0 * s) * (1.0 - s) * (1.0 - s);
+            const double h10 = s * (1.0 - s) * (1.0 - s);
+            const double h01 = s * s * (3.0 - 2.0 * s);
+            const double h11 = s * s * (s - 1.0);
+            for (const Node& node : partition.slow_boundary) {
+                const Count k = partition.fast_index[node];
+                phase[node] = h00 * fast_phases[substep][k] +
+                              h10 * substep_dt * fast_dphases[substep][k] +
+                              h01 * fast_phases[substep + 1][k] +
+                              h11 * substep_dt * fast_dphases[substep + 1][k];
+            }
+            update_sincos(slow);
+            update_sincos(partition.slow_boundary);
+            get_acceleration_subset(
+                t_csr, slow, sin_phase, cos_phase, dphase, t_params, t_result
+            );
+        };
+
+        for (Count k = 0; k < num_slow; ++k) {
+            slow_phase[k] = state[0][slow[k]];
+            slow_dphase[k] = state[1][slow[k]];
+            slow_acceleration[k] = acceleration[slow[k]];
+            slow_phase_sum[k] = slow_dphase[k];
+            slow_dphase_sum[k] = slow_acceleration[k];
+        }
+        const T half_dt = 0.5 * dt;
+        const T offsets[3] = {half_dt, half_dt, dt};
+        const T sum_weights[3] = {2.0, 2.0, 1.0};
+        for (int stage = 0; stage < 3 && num_slow > 0; ++stage) {
+            for (Count k = 0; k < num_slow; ++k) {
+                const T velocity = stage == 0 ? slow_dphase[k] : slow_stage_dphase[k];
+                slow_stage_phase[k] = slow_phase[k] + offsets[stage] * velocity;
+                slow_stage_dphase[k] =
+                    slow_dphase[k] + offsets[stage] * slow_acceleration[k];
+            }
+            evaluate_slow(
+                slow_stage_phase, slow_stage_dphase, offsets[stage], slow_acceleration
+            );
+            for (Count k = 0; k < num_slow; ++k) {
+                slow_phase_sum[k] += sum_weights[stage] * slow_stage_dphase[k];
+                slow_dphase_sum[k] += sum_weights[stage] * slow_acceleration[k];
+            }
+        }
+
+        //* New state
+        for (Count k = 0; k < num_slow; ++k) {
+            state[0][slow[k]] = slow_phase[k] + dt * slow_phase_sum[k] / 6.0;
+            state[1][slow[k]] = slow_dphase[k] + dt * slow_dphase_sum[k] / 6.0;
+        }
+        for (Count k = 0; k < num_fast; ++k) {
+            state[0][fast[k]] = fast_phases[num_substeps][k];
+            state[1][fast[k]] = fast_dphases[num_substeps][k];
+        }
+        std::swap(previous_acceleration, acceleration);
+        previous_dt = dt;
+        trajectory.emplace_back(LinearAlgebra::flatten(state));
+    }
+
+    return trajectory;
+}
+
+//* Steady state
+
+/* Steady state solver needs the Jacobian of CSR network */
+template <typename T, typename Network>
+std::vector<std::vector<T>> solve_steady(
+    const Network&,
+    const std::vector<std::vector<T>>&,
+    const std::vector<std::vector<T>>&,
+    const std::vector<T>&
+) {
+    std::cout << "Steady state solver needs csr network\n";
+    exit(1);
+}
+
+template <typename T, typename I>
+std::vector<std::vector<T>> solve_steady(
+    const CSR<T, I>& t_csr,
+    const std::vector<std::vector<T>>& t_initial_state,
+    const std::vector<std::vector<T>>& t_params,
+    const std::vector<T>& t_dts
+) {
+    /*
+    Phase-locked state by Newton's method with line search, without time steps
+
+    Every node rotates with Omega = sum P / sum gamma at a phase-locked state (see
+    solve_rotating), and its phases at the rotating frame solve N equations
+        F_i(theta) = P'_i + sum_j K_ij sin(theta_j - theta_i) = 0
+    with P' = P - gamma Omega. F is the negative gradient of the potential
+        V(theta) = -sum_i P'_i theta_i - sum_(ij) K_ij cos(theta_j - theta_i)
+    whose Hessian is L_cos (krylov.hpp), so that stable phase-locked states are
+    the local minima of V. L_cos is singular along the uniform shift of phases:
+    node 0 is kept fixed as reference (slack) node, and each Newton step solves the
+    reduced L_cos by Jacobi preconditioned conjugate gradient, truncated at
+    negative curvature (Jacobi scaled F when met at once). Steps are halved until
+    V decreases enough (Armijo) or |F| does with V within its rounding, the latter
+    for the last steps where V changes below its rounding.
+
+    No phase-locked state exists when a node needs more power than its edges can
+    carry, |P_i - gamma_i Omega| > sum_j |K_ij|. That, and Newton stalling without
+    a solution, are reported to stderr before exit.
+
+    Phases are kept modulo 2 pi nearest the initial phases, and their uniform
+    shift is fixed by sum gamma theta + sum m dtheta, which the swing equation
+    conserves at the rotating frame: without wraps, the steady state is the one the
+    dynamics from the initial state settles to, when it settles to this one.
+
+    Return
+    (S+1, 2 * N), initial state, then phase + Omega * t, Omega at each time step
+    */
+
+    constexpr int max_newton_iterations = 200;
+    constexpr int max_line_search = 30;
+    constexpr int max_krylov_iterations = 1000;
+    constexpr double krylov_tolerance = 1e-8;
+    constexpr double armijo = 1e-4;
+    constexpr Node reference = 0;
+
+    const Count num_nodes = t_initial_state[0].size();
+    const std::vector<T>& gamma = t_params[1];
+    const std::vector<T>& mass = t_params[2];
+
+    //* Power at the frame rotating with the mean frequency
+    double power_sum = 0.0, gamma_sum = 0.0;
+    for (Node node = 0; node < num_nodes; ++node) {
+        power_sum += t_params[0][node];
+        gamma_sum += gamma[node];
+    }
+    const double frequency = gamma_sum != 0.0 ? power_sum / gamma_sum : 0.0;
+    std::vector<T> power(num_nodes);
+    for (Node node = 0; node < num_nodes; ++node) {
+        power[node] = t_params[0][node] - gamma[node] * frequency;
+    }
+
+    //* Power each node needs against the capacity of its edges
+    const std::vector<double> coupling = get_total_coupling(t_csr);
+    double scale = std::abs(power_sum);
+    for (Node node = 0; node < num_nodes; ++node) {
+        const double needed = std::abs((double)power[node]);
+        if (needed > coupling[node]) {
+            std::cerr << "steady: no phase-locked state, a node needs power "
+                      << needed << " beyond its total coupling " << coupling[node]
+                      << "\n";
+            exit(1);
+        }
+        scale = std::max(scale, needed + coupling[node]);
+    }
+    const double tolerance = 1e3 * std::numeric_limits<T>::epsilon() * scale;
+    if (gamma_sum == 0.0 && std::abs(power_sum) > tolerance) {
+        std::cerr << "steady: no phase-locked state, net power " << power_sum
+                  << " without damping\n";
+        exit(1);
+    }
+
+    //* Jacobian, residual F, its norms and potential V of the phases
+    std::vector<T> phase = t_initial_state[0];
+    std::optional<CosineLaplacian<T, I>> laplacian;
+    std::vector<T> residual(num_nodes);
+    double residual_norm = 0.0, residual_max = 0.0, potential = 0.0;
+    double potential_rounding = 0.0;
+    const auto evaluate = [&]() {
+        laplacian.emplace(t_csr, phase);
+        const std::vector<T>& interaction = laplacian->get_interaction();
+        const std::vector<T>& diagonal = laplacian->get_diagonal();
+        residual_max = 0.0;
+        potential = 0.0;
+        potential_rounding = 0.0;
+        for (Node node = 0; node < num_nodes; ++node) {
+            residual[node] = power[node] + interaction[node];
+            residual_max = std::max(residual_max, std::abs((double)residual[node]));
+            potential -= (double)power[node] * phase[node] + 0.5 * diagonal[node];
+            potential_rounding +=
+                std::abs((double)power[node] * phase[node]) + 0.5 * coupling[node];
+        }
+        potential_rounding *= 16.0 * std::numeric_limits<T>::epsilon();
+        residual_norm = std::sqrt(dot(residual, residual));
+    };
+
+    // Phases modulo 2 pi nearest the initial phases: the descent of V may pass over
+    // its periodic wells, where large phases would lose precision
+    const auto wrap = [&]() {
+        for (Node node = 0; node < num_nodes; ++node) {
+            const double distance = phase[node] - t_initial_state[0][node];
+            const double wrapped = 2.0 * M_PI * std::round(distance / (2.0 * M_PI));
+            phase[node] -= wrapped;
+            potential += power[node] * wrapped;
+        }
+    };
+
+    //* Newton iterations
+    std::vector<T> rhs(num_nodes), inverse_diagonal(num_nodes);
+    std::vector<T> newton_step(num_nodes), start(num_nodes);
+    evaluate();
+    int iteration = 0;
+    bool converged = false;
+    for (; iteration < max_newton_iterations; ++iteration) {
+        SWING_PROFILE_SCOPE("step");
+        if (residual_max <= tolerance) {
+            converged = true;
+            break;
+        }
+
+        // Reduced L_cos: row and column of reference node replaced by identity
+        const std::vector<T>& diagonal = laplacian->get_diagonal();
+        for (Node node = 0; node < num_nodes; ++node) {
+            inverse_diagonal[node] =
+                diagonal[node] > 0.0
+                    ? 1.0 / diagonal[node]
+                    : (coupling[node] > 0.0 ? 1.0 / coupling[node] : 1.0);
+            rhs[node] = residual[node];
+        }
+        inverse_diagonal[reference] = 1.0;
+        rhs[reference] = 0.0;
+        std::fill(newton_step.begin(), newton_step.end(), 0.0);
+        const KrylovResult krylov = solve_conjugate_gradient(
+            [&](const std::vector<T>& t_vector, std::vector<T>& t_result) {
+                laplacian->apply(t_vector, t_result);
+                t_result[reference] = t_vector[reference];
+            },
+            inverse_diagonal,
+            rhs,
+            newton_step,
+            krylov_tolerance,
+            max_krylov_iterations
+        );
+        if (krylov.indefinite && krylov.iterations == 0) {
+            for (Node node = 0; node < num_nodes; ++node) {
+                newton_step[node] = inverse_diagonal[node] * rhs[node];
+            }
+        }
+        const double slope = -dot(rhs, newton_step);  // d/ds of V(theta + s * step)
+
+        //* Backtracking line search
+        start = phase;
+        const double start_potential = potential;
+        const double start_norm = residual_norm;
+        double step_size = 1.0;
+        bool accepted = false;
+        for (int trial = 0; trial < max_line_search && slope < 0.0; ++trial) {
+            for (Node node = 0; node < num_nodes; ++node) {
+                phase[node] = start[node] + step_size * newton_step[node];
+            }
+            evaluate();
+            // |F| alone may raise V out of its well: Newton would cycle
+            if (potential <= start_potential + armijo * step_size * slope ||
+                (residual_norm <= (1.0 - armijo * step_size) * start_norm &&
+                 potential <= start_potential + potential_rounding)) {
+                accepted = true;
+                wrap();
+                break;
+            }
+            step_size *= 0.5;
+        }
+        if (not accepted) {
+            phase = start;
+            evaluate();
+            converged = residual_max <= tolerance;
+            break;
+        }
+    }
+    if (not converged) {
+        std::cerr << "steady: no phase-locked state found, |F| = " << residual_max
+                  << " after " << iteration << " Newton iterations\n";
+        exit(1);
+    }
+
+    //* Uniform shift conserving sum gamma theta + sum m dtheta, sum m theta
+    // without damping
+    const std::vector<T>& weights = gamma_sum != 0.0 ? gamma : mass;
+    double target = 0.0, weight_sum = 0.0;
+    for (Node node = 0; node < num_nodes; ++node) {
+        target += weights[node] * ((double)t_initial_state[0][node] - phase[node]);
+        if (gamma_sum != 0.0) {
+            target += mass[node] * ((double)t_initial_state[1][node] - frequency);
+        }
+        weight_sum += weights[node];
+    }
+    const double shift = weight_sum != 0.0 ? target / weight_sum : 0.0;
+
+    //* Steady state rotating with the mean frequency
+    std::vector<std::vector<T>> trajectory;  // (S+1, 2*N)
+    trajectory.reserve(t_dts.size() + 1);
+    trajectory.emplace_back(LinearAlgebra::flatten(t_initial_state));
+
+    double time = 0.0;
+    std::vector<T> steady(2 * num_nodes, frequency);
+    for (const auto& dt : t_dts) {
+        time += dt;
+        for (Node node = 0; node < num_nodes; ++node) {
+            steady[node] = phase[node] + shift + frequency * time;
+        }
+        trajectory.emplace_back(steady);
+    }
+    return trajectory;
+}
+
+/* Increment of Runge-Kutta step of the order given in solver name. Default: rk4 */
+template <typename T, typename Network>
+std::vector<std::vector<T>> get_increment(
+    const std::string& t_solver_name,
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_state,
+    const std::vector<std::vector<T>>& t_params,
+    const T& dt
+) {
+    if (t_solver_name.find("rk1") != std::string::npos) {
+        return get_increment_rk1(t_network, t_state, t_params, dt);
+    } else if (t_solver_name.find("rk2") != std::string::npos) {
+        return get_increment_rk2(t_network, t_state, t_params, dt);
+    }
+    return get_increment_rk4(t_network, t_state, t_params, dt);
+}
+
+template <typename T, typename Network>
+std::vector<std::vector<T>> solve_compensated(
+    const std::string& t_solver_name,
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_initial_state,
+    const std::vector<std::vector<T>>& t_params,
+    const std::vector<T>& t_dts
+) {
+    /*
+    Runge-Kutta with compensated (Kahan) summation of the state update
+
+    Adding a small increment to a large phase loses the low bits of the increment
+    at every step. Rounding error of each update is kept at a compensation vector
+    and added back at the next step, so that the state stored at T accumulates
+    as if it was summed at twice the precision. Must not be compiled with
+    -ffast-math, which reassociates the compensation away.
+
+    Return
+    (S+1, 2 * N), phase1, ... phaseN, dphase1,...,dphaseN at each time step
+    */
+
+    const Count num_nodes = t_initial_state[0].size();
+    std::vector<std::vector<T>> trajectory;  // (S+1, 2*N)
+    trajectory.reserve(t_dts.size() + 1);
+    trajectory.emplace_back(LinearAlgebra::flatten(t_initial_state));
+
+    std::vector<std::vector<T>> state = t_initial_state;
+    std::vector<std::vector<T>> compensation = {
+        std::vector<T>(num_nodes, 0.0), std::vector<T>(num_nodes, 0.0)};
+    for (const auto& dt : t_dts) {
+        SWING_PROFILE_SCOPE("step");
+        const std::vector<std::vector<T>> increment =
+            get_increment(t_solver_name, t_network, state, t_params, dt);
+
+        SWING_PROFILE_SCOPE("combine");
+        for (int row = 0; row < 2; ++row) {
+            for (Node node = 0; node < num_nodes; ++node) {
+                const T corrected = increment[row][node] - compensation[row][node];
+                const T sum = state[row][node] + corrected;
+                compensation[row][node] = (sum - state[row][node]) - corrected;
+                state[row][node] = sum;
+            }
+        }
+        trajectory.emplace_back(LinearAlgebra::flatten(state));
+    }
+
+    return trajectory;
+}
+
+template <typename T, typename Network>
+std::vector<std::vector<T>> solve_rotating(
+    const std::string& t_solver_name,
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_initial_state,
+    const std::vector<std::vector<T>>& t_params,
+    const std::vector<T>& t_dts
+) {
+    /*
+    Runge-Kutta at a frame rotating with the mean frequency, phases wrapped
+
+    With nonzero net power every phase grows linearly and loses resolution at
+    float. At steady state every node rotates with Omega = sum P / sum gamma,
+    since interactions of symmetric weights sum to zero. Substituting
+    theta = theta' + Omega * t, the swing equation of theta' is the same with
+    P' = P - gamma * Omega and dtheta' = dtheta - Omega.
+    theta' is wrapped into [-pi, pi) after every step, and the number of wraps of
+    each node is counted. Trajectories are transformed back at double precision
+    theta = theta' + 2 pi * wraps + Omega * t, dtheta = dtheta' + Omega
+
+    Return
+    (S+1, 2 * N), phase1, ... phaseN, dphase1,...,dphaseN at each time step
+    */
+
+    const Count num_nodes = t_initial_state[0].size();
+    double power_sum = 0.0, gamma_sum = 0.0;
+    for (Node node = 0; node < num_nodes; ++node) {
+        power_sum += t_params[0][node];
+        gamma_sum += t_params[1][node];
+    }
+    const double frequency = gamma_sum != 0.0 ? power_sum / gamma_sum : 0.0;
+
+    //* Rotating frame
+    std::vector<std::vector<T>> params = t_params;
+    std::vector<std::vector<T>> state = t_initial_state;
+    for (Node node = 0; node < num_nodes; ++node) {
+        params[0][node] = t_params[0][node] - t_params[1][node] * frequency;
+        state[1][node] = t_initial_state[1][node] - frequency;
+    }
+
+    std::vector<double> wraps(num_nodes, 0.0);
+    const auto wrap = [&]() {
+        for (Node node = 0; node < num_nodes; ++node) {
+            const double num_wraps = std::floor((state[0][node] + M_PI) / (2.0 * M_PI));
+            if (num_wraps != 0.0) {
+                state[0][node] = state[0][node] - 2.0 * M_PI * num_wraps;
+                wraps[node] += num_wraps;
+            }
+        }
+    };
+
+    //* Transform back to the original frame
+    double time = 0.0;
+    const auto get_original = [&]() {
+        std::vector<T> original(2 * num_nodes);
+        for (Node node = 0; node < num_nodes; ++node) {
+            original[node] =
+                state[0][node] + 2.0 * M_PI * wraps[node] + frequency * time;
+            original[num_nodes + node] = state[1][node] + frequency;
+        }
+        return original;
+    };
+
+    std::vector<std::vector<T>> trajectory;  // (S+1, 2*N)
+    trajectory.reserve(t_dts.size() + 1);
+    trajectory.emplace_back(LinearAlgebra::flatten(t_initial_state));
+
+    wrap();
+    for (const auto& dt : t_dts) {
+        SWING_PROFILE_SCOPE("step");
+        const std::vector<std::vector<T>> increment =
+            get_increment(t_solver_name, t_network, state, params, dt);
+
+        SWING_PROFILE_SCOPE("combine");
+        for (int row = 0; row < 2; ++row) {
+            for (Node node = 0; node < num_nodes; ++node) {
+                state[row][node] += increment[row][node];
+            }
+        }
+        wrap();
+        time += dt;
+        trajectory.emplace_back(get_original());
+    }
+
+    return trajectory;
+}
+
+/* Solver name without any other integrator than rk1, rk2, rk4 */
+const bool is_classic_runge_kutta(const std::string& t_solver_name) {
+    for (const char* integrator :
+         {"steady", "multirate", "bdf2", "ab4", "abm4", "strang", "verlet", "leapfrog",
+          "lsrk"}) {
+        if (t_solver_name.find(integrator) != std::string::npos) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Solve with Runge-Kutta method of the order given in solver name. Default: rk4
+With "rotating" at solver name, integrated at rotating frame with wrapped phases.
+Otherwise with "mixed" at solver name, state update is compensated.
+Both wrap classic Runge-Kutta alone: combined with other integrators, exits.
+Otherwise with "steady" at solver name, phase-locked state by Newton on csr.
+Otherwise with "multirate" at solver name, rk4 with substeps of fast nodes on csr.
+Otherwise with "bdf2" at solver name, implicit BDF2 with Newton-Krylov on csr.
+Otherwise with "ab4" or "abm4" at solver name, Adams multistep bootstrapped by rk4.
+Otherwise with "strang" at solver name, exact local flow split from coupling.
+Otherwise with "verlet" or "leapfrog" at solver name, damped Verlet splitting.
+Otherwise with "lsrk3" or "lsrk4" at solver name, low-storage Runge-Kutta */
+template <typename T, typename Network>
+std::vector<std::vector<T>> solve_network(
+    const std::string& t_solver_name,
+    const Network& t_network,
+    const std::vector<std::vector<T>>& t_initial_state,
+    const std::vector<std::vector<T>>& t_params,
+    const std::vector<T>& t_dts
+) {
+    if ((t_solver_name.find("rotating") != std::string::npos ||
+         t_solver_name.find("mixed") != std::string::npos) &&
+        not is_classic_runge_kutta(t_solver_name)) {
+        std::cout << "Solver " << t_solver_name
+                  << ": mixed and rotating support only rk1, rk2, rk4\n";
+        exit(1);
+    }
+
+    if (t_solver_name.find("rotating") != std::string::npos) {
+        return solve_rotating(
+            t_solver_name, t_network, t_initial_state, t_params, t_dts
+        );
+    } else if (t_solver_name.find("mixed") != std::string::npos) {
+        return solve_compensated(
+            t_solver_name, t_network, t_initial_state, t_params, t_dts
+        );
+    } else if (t_solver_name.find("steady") != std::string::npos) {
+        return solve_steady(t_network, t_initial_state, t_params, t_dts);
+    } else if (t_solver_name.find("multirate") != std::string::npos) {
+        return solve_multirate(t_network, t_initial_state, t_params, t_dts);
+    } else if (t_solver_name.find("bdf2") != std::string::npos) {
+        return solve_bdf2(t_network, t_initial_state, t_params, t_dts);
+    } else if (t_solver_name.find("ab4") != std::string::npos ||
+               t_solver_name.find("abm4") != std::string::npos) {
+        return solve_adams(t_solver_name, t_network, t_initial_state, t_params, t_dts);
+    } else if (t_solver_name.find("strang") != std::string::npos) {
+        return solve_strang(t_network, t_initial_state, t_params, t_dts);
+    } else if (t_solver_name.find("verlet") != std::string::npos ||
+               t_solver_name.find("leapfrog") != std::string::npos) {
+        return solve_verlet(
+            t_solver_name, t_network, t_initial_state, t_params, t_dts
+        );
+    } else if (t_solver_name.find("lsrk") != std::string::npos) {
+        return solve_low_storage(
+            t_solver_name, t_network, t_initial_state, t_params, t_dts
+        );
+    } else if (t_solver_name.find("rk1") != std::string::npos) {
+        return solve_rk1(t_network, t_initial_state, t_params, t_dts);
+    } else if (t_solver_name.find("rk2") != std::string::npos) {
+        return solve_rk2(t_network, t_initial_state, t_params, t_dts);
+    }
+    return solve_rk4(t_network, t_initial_state, t_params, t_dts);
+}
+
 }  // namespace Swing
\ No newline at end of file
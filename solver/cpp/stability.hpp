@@ -0,0 +1,365 @@
+/*
+Small-signal stability of the swing equation at a state, by Lanczos iteration
+
+Linearized at phases theta, perturbations x of the phases follow
+    M x'' + Gamma x' + L_cos x = 0
+with M, Gamma diagonal of mass and gamma, and L_cos the Jacobian of krylov.hpp.
+With y = M^{1/2} x, the stiffness is the symmetric A = M^{-1/2} L_cos M^{-1/2}.
+Each eigenpair (mu, y) of A is a mode, damped by the Rayleigh quotient
+    c = sum_i gamma_i / m_i y_i^2 / |y|^2
+so that the eigenvalues of the 2N x 2N Jacobian of the state solve
+    lambda^2 + c lambda + mu = 0,  lambda = -c / 2 +- sqrt(c^2 / 4 - mu)
+with damping ratio zeta = c / (2 sqrt(mu)). Exact when gamma / m is the same at
+every node (proportional damping), first order in the rest of the damping
+otherwise. A mode with mu < 0 grows: the state is unstable.
+
+The uniform shift of phases, null vector M^{1/2} 1 of A, is neutral and deflated.
+Lanczos iteration with full reorthogonalization finds the extreme eigenvalues of A
+first: the smallest mu is the slowest overdamped mode, the largest is the mode
+of the least damping ratio under uniform damping. Ritz pairs of its tridiagonal
+matrix are found by implicit QL, and those of small residual bound are reported.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "csr.hpp"
+#include "krylov.hpp"
+#include "pcg_random.hpp"
+#include "profiler.hpp"
+
+using Node = uint64_t;
+using Count = uint64_t;
+
+namespace Swing {
+
+/*
+Eigenvalues and eigenvectors of symmetric tridiagonal matrix by implicit QL
+
+t_diagonal: (n, ), overwritten by the eigenvalues
+t_off_diagonal: (n, ), element i couples i and i+1, last one unused. Destroyed
+t_vectors: (n, n), overwritten by the eigenvectors: t_vectors[i][k] is the
+i-th component of the k-th eigenvector
+*/
+void solve_tridiagonal_eigen(
+    std::vector<double>& t_diagonal,
+    std::vector<double>& t_off_diagonal,
+    std::vector<std::vector<double>>& t_vectors
+) {
+    constexpr int max_iterations = 60;
+    const int size = t_diagonal.size();
+    std::vector<double>& d = t_diagonal;
+    std::vector<double>& e = t_off_diagonal;
+    t_vectors.assign(size, std::vector<double>(size, 0.0));
+    for (int i = 0; i < size; ++i) {
+        t_vectors[i][i] = 1.0;
+    }
+    if (size == 0) {
+        return;
+    }
+    e[size - 1] = 0.0;
+
+    for (int l = 0; l < size; ++l) {
+        for (int iteration = 0;; ++iteration) {
+            // Negligible off-diagonal element splitting the matrix
+            int m = l;
+            for (; m < size - 1; ++m) {
+                const double scale = std::abs(d[m]) + std::abs(d[m + 1]);
+                if (std::abs(e[m]) <= std::numeric_limits<double>::epsilon() * scale) {
+                    break;
+                }
+            }
+            if (m == l) {
+                break;
+            }
+            if (iteration == max_iterations) {
+                std::cout << "Tridiagonal QL did not converge\n";
+                exit(1);
+            }
+
+            // Wilkinson shift, then plane rotations chasing the bulge up to l
+            double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+            double r = std::hypot(g, 1.0);
+            g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+            double s = 1.0, c = 1.0, p = 0.0;
+            int i = m - 1;
+            for (; i >= l; --i) {
+                const double f = s * e[i];
+                const double b = c * e[i];
+                r = std::hypot(f, g);
+                e[i + 1] = r;
+                if (r == 0.0) {  // Underflow: deflate and restart
+                    d[i + 1] -= p;
+                    e[m] = 0.0;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2.0 * c * b;
+                p = s * r;
+                d[i + 1] = g + p;
+                g = c * r - b;
+                for (int k = 0; k < size; ++k) {
+                    const double v = t_vectors[k][i + 1];
+                    t_vectors[k][i + 1] = s * t_vectors[k][i] + c * v;
+                    t_vectors[k][i] = c * t_vectors[k][i] - s * v;
+                }
+            }
+            if (r == 0.0 && i >= l) {
+                continue;
+            }
+            d[l] -= p;
+            e[l] = g;
+            e[m] = 0.0;
+        }
+    }
+}
+
+/* Extreme modes of the linearized swing equation, see the top of this file */
+struct StabilityReport {
+    int iterations = 0;        // Lanczos iterations
+    Count num_converged = 0;   // Ritz pairs of small residual bound
+    double min_stiffness = 0.0;  // Smallest mu, the uniform shift excluded
+    double max_stiffness = 0.0;  // Largest mu
+    bool min_converged = false;
+    bool max_converged = false;
+    // Largest real part of lambda over converged modes, and imaginary part of the
+    // least stiff mode of real part tied with it
+    double slowest_decay = -std::numeric_limits<double>::infinity();
+    double slowest_frequency = 0.0;
+    // Least zeta over converged modes of positive mu
+    double min_damping_ratio = std::numeric_limits<double>::infinity();
+    Count num_unstable = 0;  // Converged modes of negative mu
+    bool proportional_damping = true;  // Same gamma / m at every node: c is exact
+
+    const bool is_stable() const { return num_unstable == 0 && slowest_decay < 0.0; }
+};
+
+/*
+Lanczos iteration on A = M^{-1/2} L_cos M^{-1/2} at the phases
+
+t_params: (3, N), power, gamma, mass. Power does not enter the linearization
+Stops when the smallest and largest Ritz values converge, or at t_max_iterations
+*/
+template <typename T, typename I>
+const StabilityReport analyze_stability(
+    const CSR<T, I>& t_csr,
+    const std::vector<T>& t_phase,
+    const std::vector<std::vector<T>>& t_params,
+    const int& t_max_iterations = 200
+) {
+    SWING_PROFILE_SCOPE("stability");
+    constexpr int check_interval = 10;
+    const double tolerance = std::sqrt(std::numeric_limits<T>::epsilon());
+
+    const Count num_nodes = t_phase.size();
+    const std::vector<T>& gamma = t_params[1];
+    const std::vector<T>& mass = t_params[2];
+    StabilityReport report;
+
+    std::vector<T> inverse_sqrt_mass(num_nodes), damping_rate(num_nodes);
+    for (Node node = 0; node < num_nodes; ++node) {
+        inverse_sqrt_mass[node] = 1.0 / std::sqrt((double)mass[node]);
+        damping_rate[node] = gamma[node] / mass[node];
+        report.proportional_damping =
+            report.proportional_damping &&
+            std::abs(damping_rate[node] - damping_rate[0]) <=
+                tolerance * std::abs(damping_rate[0]);
+    }
+
+    //* A = M^{-1/2} L_cos M^{-1/2}, matrix-free
+    const CosineLaplacian<T, I> laplacian(t_csr, t_phase);
+    std::vector<T> scaled(num_nodes);
+    const auto apply = [&](const std::vector<T>& t_vector, std::vector<T>& t_result) {
+        for (Node node = 0; node < num_nodes; ++node) {
+            scaled[node] = inverse_sqrt_mass[node] * t_vector[node];
+        }
+        laplacian.apply(scaled, t_result);
+        for (Node node = 0; node < num_nodes; ++node) {
+            t_result[node] *= inverse_sqrt_mass[node];
+        }
+    };
+
+    // Orthonormal basis of Lanczos vectors, null vector M^{1/2} 1 first
+    std::vector<std::vector<T>> basis(1, std::vector<T>(num_nodes));
+    for (Node node = 0; node < num_nodes; ++node) {
+        basis[0][node] = 1.0 / inverse_sqrt_mass[node];
+    }
+    const auto orthogonalize = [&](std::vector<T>& t_vector) {
+        // Classical Gram-Schmidt twice is enough to keep orthogonality
+        for (int pass = 0; pass < 2; ++pass) {
+            for (const std::vector<T>& vector : basis) {
+                const double projection = dot(vector, t_vector);
+                for (Node node = 0; node < num_nodes; ++node) {
+                    t_vector[node] -= projection * vector[node];
+                }
+            }
+        }
+        return std::sqrt(dot(t_vector, t_vector));
+    };
+    const auto normalize = [&](std::vector<T>& t_vector, const double& t_norm) {
+        for (Node node = 0; node < num_nodes; ++node) {
+            t_vector[node] /= t_norm;
+        }
+    };
+    normalize(basis[0], std::sqrt(dot(basis[0], basis[0])));
+
+    // Random start vector: no mode is missed by symmetry of the network
+    pcg64 random_engine(0);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    std::vector<T> vector(num_nodes);
+    for (Node node = 0; node < num_nodes; ++node) {
+        vector[node] = distribution(random_engine);
+    }
+    double norm = orthogonalize(vector);
+    if (num_nodes < 2 || norm == 0.0) {
+        return report;
+    }
+    normalize(vector, norm);
+    basis.push_back(vector);
+
+    //* Lanczos iterations
+    const int max_iterations = std::min<Count>(t_max_iterations, num_nodes - 1);
+    std::vector<double> alpha, beta;
+    std::vector<double> ritz_values, off_diagonal;
+    std::vector<std::vector<double>> ritz_vectors;
+    std::vector<T> product(num_nodes);
+    const auto get_ritz_pairs = [&]() {
+        ritz_values = alpha;
+        off_diagonal = beta;
+        solve_tridiagonal_eigen(ritz_values, off_diagonal, ritz_vectors);
+    };
+    // Residual |A y - mu y| of the k-th Ritz pair
+    const auto get_residual_bound = [&](const Count& t_k) {
+        return std::abs(beta.back() * ritz_vectors[alpha.size() - 1][t_k]);
+    };
+    const auto get_min_index = [&]() -> Count {
+        return std::min_element(ritz_values.begin(), ritz_values.end()) -
+               ritz_values.begin();
+    };
+    const auto get_max_index = [&]() -> Count {
+        return std::max_element(ritz_values.begin(), ritz_values.end()) -
+               ritz_values.begin();
+    };
+    const auto get_scale = [&]() {
+        return std::max(
+            std::abs(ritz_values[get_min_index()]),
+            std::abs(ritz_values[get_max_index()])
+        );
+    };
+    double matrix_scale = 0.0;  // Estimate of |A|, for breakdown of the iteration
+    while (true) {
+        apply(basis.back(), product);
+        alpha.push_back(dot(basis.back(), product));
+        norm = orthogonalize(product);
+        const double previous_beta = beta.empty() ? 0.0 : beta.back();
+        matrix_scale =
+            std::max(matrix_scale, std::abs(alpha.back()) + norm + previous_beta);
+        beta.push_back(norm);
+        ++report.iterations;
+
+        // Last iteration, or Krylov space exhausted where every Ritz pair is exact
+        const bool last = report.iterations == max_iterations ||
+                          norm <= std::numeric_limits<T>::epsilon() * matrix_scale;
+        if (last || report.iterations % check_interval == 0) {
+            get_ritz_pairs();
+            const double bound = tolerance * get_scale();
+            if (last || (get_residual_bound(get_min_index()) <= bound &&
+                         get_residual_bound(get_max_index()) <= bound)) {
+                break;
+            }
+        }
+        normalize(product, norm);
+        basis.push_back(product);
+    }
+
+    //* Modes of converged Ritz pairs
+    const Count size = alpha.size();
+    const double scale = get_scale();
+    report.min_stiffness = ritz_values[get_min_index()];
+    report.max_stiffness = ritz_values[get_max_index()];
+    report.min_converged = get_residual_bound(get_min_index()) <= tolerance * scale;
+    report.max_converged = get_residual_bound(get_max_index()) <= tolerance * scale;
+
+    std::vector<double> mode(num_nodes);
+    std::vector<double> decays, frequencies, stiffnesses;
+    for (Count k = 0; k < size; ++k) {
+        if (get_residual_bound(k) > tolerance * scale) {
+            continue;
+        }
+        ++report.num_converged;
+
+        // Ritz vector y = sum_j s_jk q_j and its modal damping
+        std::fill(mode.begin(), mode.end(), 0.0);
+        for (Count j = 0; j < size; ++j) {
+            const double weight = ritz_vectors[j][k];
+            const std::vector<T>& lanczos_vector = basis[j + 1];
+            for (Node node = 0; node < num_nodes; ++node) {
+                mode[node] += weight * lanczos_vector[node];
+            }
+        }
+        double damping = 0.0, mode_norm = 0.0;
+        for (Node node = 0; node < num_nodes; ++node) {
+            damping += damping_rate[node] * mode[node] * mode[node];
+            mode_norm += mode[node] * mode[node];
+        }
+        damping /= mode_norm;
+
+        // Root of lambda^2 + c lambda + mu = 0 of the larger real part
+        const double stiffness = ritz_values[k];
+        const double discriminant = 0.25 * damping * damping - stiffness;
+        const double decay = -0.5 * damping +
+                             (discriminant > 0.0 ? std::sqrt(discriminant) : 0.0);
+        report.slowest_decay = std::max(report.slowest_decay, decay);
+        decays.emplace_back(decay);
+        frequencies.emplace_back(discriminant < 0.0 ? std::sqrt(-discriminant) : 0.0);
+        stiffnesses.emplace_back(stiffness);
+        if (stiffness > 0.0) {
+            report.min_damping_ratio = std::min(
+                report.min_damping_ratio, damping / (2.0 * std::sqrt(stiffness))
+            );
+        } else {
+            report.num_unstable += stiffness < -tolerance * scale;
+        }
+    }
+
+    // Underdamped modes of proportional damping all decay at -gamma / 2m: decays
+    // within rounding are tied, and the least stiff of them gives the frequency,
+    // whatever the order of the Ritz pairs
+    double tied_stiffness = std::numeric_limits<double>::infinity();
+    for (Count k = 0; k < decays.size(); ++k) {
+        if (decays[k] >= report.slowest_decay - tolerance * scale &&
+            stiffnesses[k] < tied_stiffness) {
+            tied_stiffness = stiffnesses[k];
+            report.slowest_frequency = frequencies[k];
+        }
+    }
+    return report;
+}
+
+/* Report as "key value" per line, with maximum precision */
+void write_stability_report(std::ostream& t_stream, const StabilityReport& t_report) {
+    t_stream << std::setprecision(std::numeric_limits<double>::digits10 + 1)
+             << "stable " << t_report.is_stable() << "\n"
+             << "slowest_decay " << t_report.slowest_decay << "\n"
+             << "slowest_frequency " << t_report.slowest_frequency << "\n"
+             << "min_damping_ratio " << t_report.min_damping_ratio << "\n"
+             << "min_stiffness " << t_report.min_stiffness << "\n"
+             << "max_stiffness " << t_report.max_stiffness << "\n"
+             << "min_converged " << t_report.min_converged << "\n"
+             << "max_converged " << t_report.max_converged << "\n"
+             << "unstable_modes " << t_report.num_unstable << "\n"
+             << "converged_modes " << t_report.num_converged << "\n"
+             << "iterations " << t_report.iterations << "\n"
+             << "proportional_damping " << t_report.proportional_damping << "\n";
+}
+
+}  // namespace Swing
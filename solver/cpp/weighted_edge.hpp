@@ -1,17 +1,21 @@
 #pragma once
 
+#include <cstdint>
+
 using Node = uint64_t;
 namespace Swing {
 
-template <typename T>
+/* Edge between node1 and node2 with weight
+Index type I is uint32_t by default, which is enough for graphs under 4B nodes */
+template <typename T, typename I = uint32_t>
 struct WeightedEdge {
-    Node node1;
-    Node node2;
+    I node1;
+    I node2;
     T weight;
 
     WeightedEdge() {}
-    WeightedEdge(const Node& t_node1, const Node& t_node2, const T& t_weight)
+    WeightedEdge(const I& t_node1, const I& t_node2, const T& t_weight)
         : node1(t_node1), node2(t_node2), weight(t_weight) {}
 };
 
-}  // namespace Swing
\ No newline at end of file
+}  // namespace Swing
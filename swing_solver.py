@@ -1,4 +1,8 @@
+import shlex
+import string
+import subprocess
 from functools import partial
+from pathlib import Path
 from typing import Callable, cast, overload
 
 import networkx as nx
@@ -27,40 +31,39 @@ def directed2undirected(
     ).T  # pyright: ignore
 
 
-def step_solve_cpp(
-    solver_name: str,
+SOLVER_DIR = Path(__file__).resolve().parent / "solver"
+CPP_EXECUTABLE = SOLVER_DIR / "simulation.out"
+
+
+def compile_cpp(executable: Path = CPP_EXECUTABLE) -> None:
+    """Compile cpp solver when executable does not exist or is older than any
+    source, so that a stale executable never runs with old dispatch or flags"""
+    sources = [*SOLVER_DIR.glob("cpp/*.hpp"), *SOLVER_DIR.glob("cpp/*.cpp")]
+    if executable.exists() and all(
+        source.stat().st_mtime <= executable.stat().st_mtime for source in sources
+    ):
+        return
+    subprocess.run(
+        shlex.split(
+            f"g++ -O2 -flto=auto -fopenmp -std=c++17 -o {executable} "
+            f"{SOLVER_DIR}/cpp/main_python.cpp"
+        ),
+        check=True,
+    )
+
+
+def write_cpp_arg_file(
+    arg_file: Path,
     edge_list: npt.NDArray[np.int64],
     weights: arr,
     phase: arr,
     dphase: arr,
     params: arr,
     dts: arr,
-) -> arr:
-    import shlex
-    import string
-    import subprocess
-    from pathlib import Path
-
-    SOLVER_DIR = Path(__file__).resolve().parent / "solver"
-    HASH = "".join(s for s in np.random.choice(list(string.ascii_letters), 10))
-    ARG_FILE = SOLVER_DIR / f"tmp_{HASH}.txt"
-    EXECUTABLE = SOLVER_DIR / "simulation.out"
-
-    precision = 32 if dts.dtype == np.float32 else 64
+) -> None:
+    """Write arguments of cpp solver, one value per line"""
     digits = 6 if dts.dtype == np.float32 else 16
-
-    # compile
-    if not EXECUTABLE.exists():
-        subprocess.run(
-            shlex.split(
-                f"g++ -O2 -flto=auto -std=c++17 -o {EXECUTABLE} "
-                f"{SOLVER_DIR}/cpp/main_python.cpp"
-            )
-        )
-
-    # Change arguments to input of executable
-    num_nodes, num_edges, num_steps = len(phase), len(edge_list), len(dts)
-    with open(ARG_FILE, "w") as f:
+    with open(arg_file, "w") as f:
         f.write("\n".join(f"{p:.{digits}f}" for p in phase) + "\n")
         f.write("\n".join(f"{p:.{digits}f}" for p in dphase) + "\n")
         f.write("\n".join(f"{p:.{digits}f}" for p in params[0]) + "\n")
@@ -74,17 +77,93 @@ def step_solve_cpp(
         )
         f.write("\n" + "\n".join(f"{dt:.{digits}f}" for dt in dts))
 
+
+def get_cpp_command(
+    solver_name: str,
+    num_nodes: int,
+    num_edges: int,
+    num_steps: int,
+    precision: int,
+    arg_file: Path,
+    executable: Path = CPP_EXECUTABLE,
+) -> list[str]:
+    return shlex.split(
+        f"{executable} {solver_name} {num_nodes} {num_edges} {num_steps} {precision} {arg_file}"
+    )
+
+
+def parse_cpp_output(result: str, dtype: npt.DTypeLike, num_nodes: int) -> arr:
+    """Output of cpp solver to (S+1, 2, N) trajectory"""
+    trajectory = cast(arr, np.array(result.strip().split(), dtype=dtype))
+    return trajectory.reshape(-1, 2, num_nodes)
+
+
+def step_solve_cpp(
+    solver_name: str,
+    edge_list: npt.NDArray[np.int64],
+    weights: arr,
+    phase: arr,
+    dphase: arr,
+    params: arr,
+    dts: arr,
+) -> arr:
+    HASH = "".join(s for s in np.random.choice(list(string.ascii_letters), 10))
+    ARG_FILE = SOLVER_DIR / f"tmp_{HASH}.txt"
+
+    precision = 32 if dts.dtype == np.float32 else 64
+
+    # compile
+    compile_cpp()
+
+    # Change arguments to input of executable
+    num_nodes, num_edges, num_steps = len(phase), len(edge_list), len(dts)
+    write_cpp_arg_file(ARG_FILE, edge_list, weights, phase, dphase, params, dts)
+
     # Run executable
     result = subprocess.check_output(
-        shlex.split(
-            f"{EXECUTABLE} {solver_name} {num_nodes} {num_edges} {num_steps} {precision} {ARG_FILE}"
+        get_cpp_command(
+            solver_name, num_nodes, num_edges, num_steps, precision, ARG_FILE
         ),
         text=True,
     )
     ARG_FILE.unlink()
 
-    trajectory = cast(arr, np.array(result.strip().split(), dtype=dts.dtype))
-    return trajectory.reshape(-1, 2, num_nodes)
+    return parse_cpp_output(result, dts.dtype, num_nodes)
+
+
+def analyze_stability_cpp(
+    solver_name: str,
+    graph: nx.Graph,
+    weights: arr,
+    phase: arr,
+    dphase: arr,
+    params: arr,
+) -> dict[str, float]:
+    """
+    Small-signal stability of swing equation linearized at the phases, by cpp solver
+
+    solver_name: "stability_cpp" at the given phases, or "steady_stability_cpp" at
+    the phase-locked state found from them. Backend as in solve, e.g., "_rcm"
+    Return: stable, slowest_decay, min_damping_ratio, ..., see solver/cpp/stability.hpp
+    """
+    HASH = "".join(s for s in np.random.choice(list(string.ascii_letters), 10))
+    ARG_FILE = SOLVER_DIR / f"tmp_{HASH}.txt"
+
+    precision = 32 if phase.dtype == np.float32 else 64
+    compile_cpp()
+
+    edge_list = get_edge_list(graph)
+    num_nodes, num_edges = len(phase), len(edge_list)
+    dts = np.zeros(0, dtype=phase.dtype)
+    write_cpp_arg_file(ARG_FILE, edge_list, weights, phase, dphase, params, dts)
+
+    result = subprocess.check_output(
+        get_cpp_command(solver_name, num_nodes, num_edges, 0, precision, ARG_FILE),
+        text=True,
+    )
+    ARG_FILE.unlink()
+
+    return {key: float(value) for key, value in map(str.split, result.splitlines())}
 
 
 def step_solve(